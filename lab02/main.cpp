@@ -3,40 +3,34 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <charconv>
+#include <cmath>
 #include <cstring>
+#include <cstdlib>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-std::vector<glm::vec3> vertices;
+#include "mesh_cache.hpp"
+#include "profile.hpp"
+#include "weld.hpp"
 
-bool loadOBJ(const std::string& path) {
-    FILE* file = std::fopen(path.c_str(), "r");
-    if (!file) {
-        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+objloader::IndexedMesh mesh;
+
+bool loadOBJ(const std::string& path, float epsilon) {
+    // Só posições: cantos com o mesmo "v" já viram um único vértice
+    if (!objloader::loadCached(path, mesh, {.attributes = objloader::Positions})) {
         return false;
     }
 
-    std::vector<glm::vec3> tempPositions; 
-
-    char line[128];
-    while (std::fgets(line, sizeof(line), file)) {
-        if (line[0] == 'v') { 
-            glm::vec3 vertex;
-            std::sscanf(line, "v %f %f %f", &vertex.x, &vertex.y, &vertex.z);
-            
-            tempPositions.push_back(vertex);
-        } 
-        else if (line[0] == 'f') {
-            unsigned int vIndex[3];
-            std::sscanf(line, "f %d %d %d", &vIndex[0], &vIndex[1], &vIndex[2]);
-            
-            vertices.push_back(tempPositions[vIndex[0] - 1]);
-            vertices.push_back(tempPositions[vIndex[1] - 1]);
-            vertices.push_back(tempPositions[vIndex[2] - 1]);
+    // Funde também posições repetidas em "v" diferentes
+    if (epsilon > 0.0f) {
+        objloader::MeshBuffers welded;
+        if (!objloader::weldVertices(mesh, epsilon, welded)) {
+            std::cerr << "Epsilon " << epsilon << " pequeno demais para as coordenadas do modelo" << std::endl;
+            return false;
         }
+        mesh = objloader::IndexedMesh::fromBuffers(std::move(welded));
     }
-    
-    std::fclose(file);
 
     return true;
 }
@@ -78,10 +72,10 @@ GLuint createShaderProgram() {
 }
 
 glm::vec3 getCentroModelo() {
-    glm::vec3 min = vertices[0];
-    glm::vec3 max = vertices[0];
+    glm::vec3 min = mesh.vertices[0];
+    glm::vec3 max = mesh.vertices[0];
 
-    for (const auto& vertex : vertices) {
+    for (const auto& vertex : mesh.vertices) {
         min = glm::min(min, vertex);
         max = glm::max(max, vertex);
     }
@@ -112,18 +106,22 @@ int render() {
 
     GLuint shaderProgram = createShaderProgram();
 
-    GLuint VAO, VBO;
+    GLuint VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
     
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size_bytes(), mesh.vertices.data(), GL_STATIC_DRAW);
     
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.triangles.size_bytes(), mesh.triangles.data(), GL_STATIC_DRAW);
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
@@ -148,7 +146,7 @@ int render() {
         glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
         
         glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+        glDrawElements(GL_TRIANGLES, mesh.triangles.size() * 3, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
     
         glfwSwapBuffers(window);
@@ -162,12 +160,25 @@ int render() {
 }
 
 int main(int argc, char **argv) {
+    argc = objloader::profile::init(argc, argv);
+
     if (argc < 2) {
         std::cerr << "Invalid input" << std::endl;
         return 1;
     }
 
-    if (!loadOBJ(argv[1])) {
+    // argv[2] opcional: distância máxima para fundir vértices
+    float epsilon = 0.0f;
+    if (argc > 2) {
+        const char* end = argv[2] + std::strlen(argv[2]);
+        auto [ptr, ec] = std::from_chars(argv[2], end, epsilon);
+        if (ec != std::errc() || ptr != end || !std::isfinite(epsilon) || epsilon < 0.0f) {
+            std::cerr << "Epsilon inválido: " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+
+    if (!loadOBJ(argv[1], epsilon)) {
         return 1;
     }
 
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <cstdio>
 
+#include "objloader.hpp"
+
 struct Vertex {
     glm::vec3 position;
 };
@@ -14,40 +16,22 @@ std::vector<Vertex> vertices;
 std::vector<unsigned int> indices;
 
 bool loadOBJ(const std::string& path) {
-    FILE* file = std::fopen(path.c_str(), "r");
-    if (!file) {
-        std::cerr << "Erro ao abrir arquivo: " << path << std::endl;
-        return false;
-    }
-
-    std::vector<glm::vec3> temp_positions;
-    std::vector<unsigned int> temp_indices;
-
-    char line[128];
-    while (std::fgets(line, sizeof(line), file)) {
-        if (line[0] == 'v' && line[1] == ' ') { 
-            glm::vec3 vertex;
-            std::sscanf(line, "v %f %f %f", &vertex.x, &vertex.y, &vertex.z);
-            temp_positions.push_back(vertex);
-        } 
-        else if (line[0] == 'f') {
-            unsigned int vIndex[3];
-            std::sscanf(line, "f %u %u %u", &vIndex[0], &vIndex[1], &vIndex[2]);
-
-            temp_indices.push_back(vIndex[0] - 1);
-            temp_indices.push_back(vIndex[1] - 1);
-            temp_indices.push_back(vIndex[2] - 1);
-        }
-    }
+    objloader::ObjData data;
+    if (!objloader::parse(path, data)) return false;
 
+    // Só as posições interessam aqui: quads e n-gons já chegam triangulados
     vertices.clear();
-    indices = temp_indices;
+    indices.clear();
+    indices.reserve(data.corners.size());
 
-    for (const auto& pos : temp_positions) {
+    for (const auto& pos : data.positions) {
         vertices.push_back({ pos });
     }
 
-    std::fclose(file);
+    for (const auto& c : data.corners) {
+        indices.push_back(c.v);
+    }
+
     return true;
 }
 
@@ -2,9 +2,14 @@
 #include <fstream>
 #include <vector>
 #include <cmath>
+#include <charconv>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
 
+#include "obj_stream.hpp"
+#include "profile.hpp"
+
 struct Ray {
     glm::vec3 origin;
     glm::vec3 direction;
@@ -23,32 +28,16 @@ glm::vec3 specularColor = glm::vec3(1.0f, 0.3f, 0.3f);
 
 float shininess = 51.2f;  
 
+// Só as posições ficam em memória (e contam no limite); as faces são lidas
+// em lotes no main
 std::vector<glm::vec3> vertices;  
-std::vector<glm::ivec3> faceIndices;
+objloader::StreamOptions streamOptions;
 
 
 bool loadOBJ(const std::string& path) {
-    FILE* file = std::fopen(path.c_str(), "r");
-    if (!file) {
-        std::cerr << "Failed to open OBJ file: " << path << std::endl;
-        return false;
-    }
-
-    char line[128];
-    while (std::fgets(line, sizeof(line), file)) {
-        if (line[0] == 'v' && line[1] == ' ') {
-            glm::vec3 vertex;
-            std::sscanf(line, "v %f %f %f", &vertex.x, &vertex.y, &vertex.z);
-            vertices.push_back(vertex);
-        } else if (line[0] == 'f') {
-            unsigned int vIndex[3];
-            std::sscanf(line, "f %d %d %d", &vIndex[0], &vIndex[1], &vIndex[2]);
-            faceIndices.emplace_back(vIndex[0], vIndex[1], vIndex[2]);
-        }
-    }
-
-    std::fclose(file);
-    return true;
+    return objloader::streamPositions(path, streamOptions, [](std::span<const glm::vec3> block) {
+        vertices.insert(vertices.end(), block.begin(), block.end());
+    });
 }
 
 bool intersectRayTriangle(const Ray &ray, const Triangle &tri, float &tOut) {
@@ -101,10 +90,23 @@ glm::vec3 computeADS(glm::vec3 pos, glm::vec3 normal) {
 }
 
 int main(int argc, char** argv) {
+    argc = objloader::profile::init(argc, argv);
+
     if (argc < 2) {
-        std::cerr << "Uso: " << argv[0] << " <arquivo.obj>" << std::endl;
+        std::cerr << "Uso: " << argv[0] << " <arquivo.obj> [limite_memoria_MB] [--profile] [--profile-json=arquivo]" << std::endl;
         return 1;
     }
+    if (argc > 2) {
+        const char* end = argv[2] + std::strlen(argv[2]);
+        size_t megabytes = 0;
+        auto [ptr, ec] = std::from_chars(argv[2], end, megabytes);
+        if (ec != std::errc() || ptr != end || megabytes == 0 || megabytes > (SIZE_MAX >> 20)) {
+            std::cerr << "Limite de memória inválido: " << argv[2] << std::endl;
+            return 1;
+        }
+        streamOptions.memoryLimit = megabytes << 20;
+        streamOptions.windowBytes = std::min(streamOptions.windowBytes, streamOptions.memoryLimit / 2);
+    }
     if (!loadOBJ(argv[1])) {
         std::cerr << "Erro ao carregar o arquivo OBJ." << std::endl;
         return 1;
@@ -149,52 +151,59 @@ int main(int argc, char** argv) {
     }
 
     int triIndex = 0;
-    for (auto& f : faceIndices) {
-        Triangle tri;
-        tri.v0 = vertices[f.x - 1];  
-        tri.v1 = vertices[f.y - 1];
-        tri.v2 = vertices[f.z - 1];
-        tri.normal = glm::normalize(glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
+    bool ok = objloader::streamTriangles(argv[1], vertices, streamOptions, [&](const objloader::TriangleBatch& batch) {
+        for (size_t k = 0; k < batch.indices.size(); ++k) {
+            Triangle tri;
+            tri.v0 = batch.corners[3 * k];
+            tri.v1 = batch.corners[3 * k + 1];
+            tri.v2 = batch.corners[3 * k + 2];
+            tri.normal = glm::normalize(glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
 
-    
-        glm::vec3 hitPoint;
-        bool hit = false;
         
-        for (const Ray& ray : rays) {
-            float t;
-            if (intersectRayTriangle(ray, tri, t)) {
-                hitPoint = ray.origin + ray.direction * t;
-                hit = true;
-                break;
+            glm::vec3 hitPoint;
+            bool hit = false;
+            
+            for (const Ray& ray : rays) {
+                float t;
+                if (intersectRayTriangle(ray, tri, t)) {
+                    hitPoint = ray.origin + ray.direction * t;
+                    hit = true;
+                    break;
+                }
             }
-        }
 
-        glm::vec3 finalColor;
-        if (hit) {
-            finalColor = computeADS(hitPoint, tri.normal);
-        } 
-        else {
-            glm::vec3 c0 = computeADS(tri.v0, tri.normal);
-            glm::vec3 c1 = computeADS(tri.v1, tri.normal);
-            glm::vec3 c2 = computeADS(tri.v2, tri.normal);
-            finalColor = (c0 + c1 + c2) / 3.0f;
-        }
+            glm::vec3 finalColor;
+            if (hit) {
+                finalColor = computeADS(hitPoint, tri.normal);
+            } 
+            else {
+                glm::vec3 c0 = computeADS(tri.v0, tri.normal);
+                glm::vec3 c1 = computeADS(tri.v1, tri.normal);
+                glm::vec3 c2 = computeADS(tri.v2, tri.normal);
+                finalColor = (c0 + c1 + c2) / 3.0f;
+            }
+
+            finalColor = glm::clamp(finalColor, glm::vec3(0.0f), glm::vec3(1.0f));
 
-        finalColor = glm::clamp(finalColor, glm::vec3(0.0f), glm::vec3(1.0f));
+            // Exporta o material
+            char matName[64];
+            sprintf(matName, "mat%d", triIndex);
+            mtlOut << "newmtl " << matName << "\n";
+            mtlOut << "Kd " << finalColor.r << " " << finalColor.g << " " << finalColor.b << "\n\n";
 
-        // Exporta o material
-        char matName[64];
-        sprintf(matName, "mat%d", triIndex);
-        mtlOut << "newmtl " << matName << "\n";
-        mtlOut << "Kd " << finalColor.r << " " << finalColor.g << " " << finalColor.b << "\n\n";
+            unsigned i0 = batch.indices[k][0] + 1;
+            unsigned i1 = batch.indices[k][1] + 1;
+            unsigned i2 = batch.indices[k][2] + 1;
+            objOut << "usemtl " << matName << "\n";
+            objOut << "f " << i0 << " " << i1 << " " << i2 << "\n";
 
-        int i0 = faceIndices[triIndex].x;
-        int i1 = faceIndices[triIndex].y;
-        int i2 = faceIndices[triIndex].z;
-        objOut << "usemtl " << matName << "\n";
-        objOut << "f " << i0 << " " << i1 << " " << i2 << "\n";
+            triIndex++;
+        }
+    });
 
-        triIndex++;
+    if (!ok) {
+        std::cerr << "Erro ao ler as faces do arquivo OBJ." << std::endl;
+        return 1;
     }
         
     objOut.close();
@@ -0,0 +1,178 @@
+// Microbenchmark do tokenizador: sscanf, strtof, std::from_chars e
+// scan::parseFloat (atalho SIMD + volta exata), mais a busca de '\n'.
+//
+// Uso: bench_tokenizer [quantidade_de_numeros]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "scan.hpp"
+
+using namespace objloader;
+
+namespace {
+
+template <typename F>
+double timeMs(F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// Números separados por espaço, uma linha "v x y z" a cada três
+std::string makeText(size_t count, const char* format, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    std::string text;
+    char buf[64];
+
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 3 == 0) text += "v";
+        std::snprintf(buf, sizeof(buf), format, dist(rng));
+        text += ' ';
+        text += buf;
+        if (i % 3 == 2) text += '\n';
+    }
+    text += '\n';
+    return text;
+}
+
+void benchFloats(const char* label, const std::string& text, size_t count) {
+    std::vector<float> expected(count), got(count);
+    const char* end = text.data() + text.size();
+
+    auto next = [end](const char* p) {
+        p = scan::skipBlanks(p, end);
+        if (*p == '\n') p = scan::skipBlanks(p + 1, end);
+        if (*p == 'v') ++p;
+        return scan::skipBlanks(p, end);
+    };
+
+    double fromChars = timeMs([&] {
+        const char* p = text.data();
+        for (size_t i = 0; i < count; ++i) {
+            p = next(p);
+            p = std::from_chars(p, end, expected[i]).ptr;
+        }
+    });
+
+    // Como os loadOBJ antigos: linha copiada num buffer de 128 bytes + sscanf
+    double sscanfMs = timeMs([&] {
+        const char* p = text.data();
+        char line[128];
+        for (size_t i = 0; i + 2 < count; i += 3) {
+            const char* nl = simd::findNewline(p, end);
+            size_t len = std::min<size_t>(nl - p, sizeof(line) - 1);
+            std::memcpy(line, p, len);
+            line[len] = '\0';
+            std::sscanf(line, "v %f %f %f", &got[i], &got[i + 1], &got[i + 2]);
+            p = nl + 1;
+        }
+    });
+
+    double strtofMs = timeMs([&] {
+        const char* p = text.data();
+        for (size_t i = 0; i < count; ++i) {
+            p = next(p);
+            char* stop;
+            got[i] = std::strtof(p, &stop);
+            p = stop;
+        }
+    });
+
+    double scanMs = timeMs([&] {
+        const char* p = text.data();
+        for (size_t i = 0; i < count; ++i) {
+            p = next(p);
+            p = scan::parseFloat(p, end, got[i]);
+        }
+    });
+
+    // Fração dos números resolvidos pelo atalho (fora da medição)
+    size_t fast = 0;
+    for (const char* p = text.data(); p < end;) {
+        p = next(p);
+        if (p >= end) break;
+        float value;
+        const char* q = simd::parseFloatFast(p, end, value);
+        fast += q != nullptr;
+        p = q ? q : std::from_chars(p, end, value).ptr;
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        mismatches += std::memcmp(&expected[i], &got[i], sizeof(float)) != 0;
+    }
+
+    auto ns = [count](double ms) { return ms * 1e6 / count; };
+    std::printf("%-10s sscanf %7.1f ns | strtof %6.1f ns | from_chars %6.1f ns | parseFloat %6.1f ns"
+                " | atalho %5.1f%% | diferenças %zu\n",
+                label, ns(sscanfMs), ns(strtofMs), ns(fromChars), ns(scanMs),
+                100.0 * fast / count, mismatches);
+}
+
+void benchNewlines(const std::string& text) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    size_t lines[3] = {};
+
+    double scalar = timeMs([&] {
+        for (const char* p = begin; p < end; ++p) lines[0] += *p == '\n';
+    });
+
+    double memchrMs = timeMs([&] {
+        for (const char* p = begin; p < end;) {
+            const void* nl = std::memchr(p, '\n', end - p);
+            if (!nl) break;
+            ++lines[1];
+            p = static_cast<const char*>(nl) + 1;
+        }
+    });
+
+    double simdMs = timeMs([&] {
+        for (const char* p = begin; p < end;) {
+            p = simd::findNewline(p, end);
+            if (p == end) break;
+            ++lines[2];
+            ++p;
+        }
+    });
+
+    auto gbs = [&](double ms) { return text.size() / (ms * 1e6); };
+    std::printf("quebras    escalar %5.2f GB/s | memchr %5.2f GB/s | findNewline %5.2f GB/s | linhas %zu/%zu/%zu\n",
+                gbs(scalar), gbs(memchrMs), gbs(simdMs), lines[0], lines[1], lines[2]);
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 3000000;
+    count -= count % 3;
+
+    std::mt19937 rng(937);
+
+#if defined(__AVX2__)
+    std::printf("SIMD: AVX2\n");
+#elif defined(__SSE2__)
+    std::printf("SIMD: SSE2\n");
+#else
+    std::printf("SIMD: nenhum\n");
+#endif
+
+    std::string fixed = makeText(count, "%.6f", rng);
+    std::string full = makeText(count, "%.17g", rng);
+    std::string sci = makeText(count, "%.6e", rng);
+
+    benchFloats("%.6f", fixed, count);
+    benchFloats("%.17g", full, count);
+    benchFloats("%.6e", sci, count);
+    benchNewlines(full);
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "objloader.hpp"
+
+namespace objloader {
+
+// Tabela hash de endereçamento aberto (sondagem linear) de Corner -> índice de
+// vértice. A chave é a tripla (v, t + 1, n + 1) em 96 bits e cada entrada
+// ocupa 16 bytes contíguos.
+class CornerMap {
+    struct Slot {
+        uint32_t v;
+        uint32_t t;
+        uint32_t n;
+        uint32_t value;
+    };
+
+    static constexpr uint32_t emptyKey = UINT32_MAX;
+
+    std::vector<Slot> slots;
+    size_t mask{0};
+    size_t count{0};
+    size_t probeCount{0};
+
+public:
+    // expected: número de cantos distintos estimado
+    explicit CornerMap(size_t expected) {
+        rehash(std::bit_ceil(std::max<size_t>(16, expected + expected / 2)));
+    }
+
+    size_t size() const { return count; }
+
+    // Entradas examinadas por tryEmplace desde a criação
+    size_t probes() const { return probeCount; }
+
+    // Retorna o índice já associado ao canto ou associa value a ele.
+    std::pair<unsigned, bool> tryEmplace(const Corner& c, unsigned value) {
+        if ((count + 1) * 10 > slots.size() * 7) rehash(slots.size() * 2);
+
+        const uint32_t v = c.v, t = c.t + 1, n = c.n + 1;
+        for (size_t i = hash(v, t, n) & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            ++probeCount;
+            if (slot.v == emptyKey) {
+                slot = {v, t, n, value};
+                ++count;
+                return {value, true};
+            }
+            if (slot.v == v && slot.t == t && slot.n == n) {
+                return {slot.value, false};
+            }
+        }
+    }
+
+private:
+    static size_t hash(uint32_t v, uint32_t t, uint32_t n) {
+        uint64_t h = (uint64_t(v) | uint64_t(t) << 32) * 0x9e3779b97f4a7c15ull;
+        h ^= uint64_t(n) * 0xc2b2ae3d27d4eb4full;
+        return size_t(h ^ (h >> 29));
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(capacity, Slot{emptyKey, 0, 0, 0});
+        mask = capacity - 1;
+
+        for (const Slot& slot : old) {
+            if (slot.v == emptyKey) continue;
+            size_t i = hash(slot.v, slot.t, slot.n) & mask;
+            while (slots[i].v != emptyKey) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+};
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace objloader {
+
+// Arquivo mapeado somente para leitura (mmap). Um arquivo vazio é válido e
+// tem data() == nullptr.
+class MappedFile {
+    const char* ptr{nullptr};
+    size_t length{0};
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return ptr; }
+    const char* end() const { return ptr + length; }
+    size_t size() const { return length; }
+};
+
+}
@@ -0,0 +1,213 @@
+#include "mesh_cache.hpp"
+#include "mapped_file.hpp"
+#include "profile.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <climits>
+#include <cstdlib>
+#include <sys/stat.h>
+
+namespace objloader {
+
+namespace {
+
+constexpr char cacheMagic[8] = {'M', 'C', '9', '3', '7', 'M', 'S', 'H'};
+constexpr uint32_t cacheVersion = 2;
+
+// Atributos que mudam o conteúdo da malha indexada
+constexpr unsigned meshAttributes = Normals | Texcoords;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t pathHash;
+    uint64_t vertexCount;
+    uint64_t triangleCount;
+    uint32_t attributes;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CacheHeader) == 64);
+
+struct SourceKey {
+    uint64_t size;
+    int64_t mtime;
+    uint64_t pathHash;
+};
+
+// FNV-1a de 64 bits
+uint64_t hashString(const std::string& s) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+bool sourceKey(const std::string& objPath, SourceKey& key) {
+    struct stat st;
+    if (::stat(objPath.c_str(), &st) != 0) return false;
+
+    char resolved[PATH_MAX];
+    std::string absolute = ::realpath(objPath.c_str(), resolved) ? resolved : objPath;
+
+    key.size = st.st_size;
+    key.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    key.pathHash = hashString(absolute);
+    return true;
+}
+
+constexpr size_t align16(size_t n) {
+    return (n + 15) & ~size_t(15);
+}
+
+// Deslocamentos dos arrays no arquivo, alinhados a 16 bytes
+struct Layout {
+    size_t vertices, normals, triangles, total;
+
+    Layout(uint64_t vertexCount, uint64_t triangleCount, bool withNormals) {
+        vertices = align16(sizeof(CacheHeader));
+        normals = align16(vertices + vertexCount * sizeof(glm::vec3));
+        triangles = align16(normals + (withNormals ? vertexCount : 0) * sizeof(glm::vec3));
+        total = triangles + triangleCount * sizeof(std::array<unsigned, 3>);
+    }
+};
+
+}
+
+std::string cachePath(const std::string& objPath) {
+    return objPath + ".mcache";
+}
+
+bool readCache(const std::string& objPath, IndexedMesh& mesh, unsigned attributes) {
+    SourceKey key;
+    if (!sourceKey(objPath, key)) return false;
+
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(cachePath(objPath)) || file->size() < sizeof(CacheHeader)) return false;
+
+    CacheHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+        header.version != cacheVersion ||
+        header.headerSize != sizeof(CacheHeader) ||
+        header.sourceSize != key.size ||
+        header.sourceMtime != key.mtime ||
+        header.pathHash != key.pathHash) {
+        return false;
+    }
+
+    // Um cache com mais atributos que o pedido também serve
+    const unsigned wanted = attributes & meshAttributes;
+    if ((header.attributes & wanted) != wanted) return false;
+
+    // Contagens absurdas estourariam as multiplicações do Layout
+    if (header.vertexCount > file->size() / sizeof(glm::vec3) ||
+        header.triangleCount > file->size() / sizeof(std::array<unsigned, 3>)) {
+        return false;
+    }
+
+    const bool cachedNormals = header.attributes & Normals;
+    Layout layout(header.vertexCount, header.triangleCount, cachedNormals);
+    if (layout.total != file->size()) return false;
+
+    // Um cache corrompido com tamanho e mtime certos ainda pode apontar para
+    // vértices que não existem: nesse caso o OBJ é lido de novo
+    const char* base = file->data();
+    std::span<const std::array<unsigned, 3>> triangles(
+        reinterpret_cast<const std::array<unsigned, 3>*>(base + layout.triangles), header.triangleCount);
+    for (const auto& tri : triangles) {
+        if (tri[0] >= header.vertexCount || tri[1] >= header.vertexCount || tri[2] >= header.vertexCount) return false;
+    }
+
+    mesh.vertices = {reinterpret_cast<const glm::vec3*>(base + layout.vertices), header.vertexCount};
+    if (attributes & Normals) {
+        mesh.normals = {reinterpret_cast<const glm::vec3*>(base + layout.normals), header.vertexCount};
+    }
+    else {
+        mesh.normals = {};
+    }
+    mesh.triangles = triangles;
+    mesh.storage = std::move(file);
+    return true;
+}
+
+bool writeCache(const std::string& objPath, const IndexedMesh& mesh, unsigned attributes) {
+    SourceKey key;
+    if (!sourceKey(objPath, key)) return false;
+
+    CacheHeader header{};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.headerSize = sizeof(CacheHeader);
+    header.sourceSize = key.size;
+    header.sourceMtime = key.mtime;
+    header.pathHash = key.pathHash;
+    header.vertexCount = mesh.vertices.size();
+    header.triangleCount = mesh.triangles.size();
+
+    // Sem uma normal por vértice o cache não pode atender pedidos com Normals
+    const bool withNormals = !mesh.normals.empty() && mesh.normals.size() == mesh.vertices.size();
+    header.attributes = attributes & meshAttributes & (withNormals ? ~0u : ~unsigned(Normals));
+
+    Layout layout(header.vertexCount, header.triangleCount, withNormals);
+
+    // Grava num temporário e renomeia para nunca expor um cache incompleto
+    const std::string finalPath = cachePath(objPath);
+    const std::string tmpPath = finalPath + ".tmp";
+
+    FILE* out = std::fopen(tmpPath.c_str(), "wb");
+    if (!out) return false;
+
+    static const char padding[16] = {};
+    auto writeAt = [&](size_t offset, const void* data, size_t bytes) {
+        long pos = std::ftell(out);
+        if (pos < 0 || (size_t)pos > offset) return false;
+        if (std::fwrite(padding, 1, offset - pos, out) != offset - (size_t)pos) return false;
+        return bytes == 0 || std::fwrite(data, 1, bytes, out) == bytes;
+    };
+
+    bool ok = writeAt(0, &header, sizeof(header)) &&
+              writeAt(layout.vertices, mesh.vertices.data(), mesh.vertices.size_bytes()) &&
+              (!withNormals || writeAt(layout.normals, mesh.normals.data(), mesh.normals.size_bytes())) &&
+              writeAt(layout.triangles, mesh.triangles.data(), mesh.triangles.size_bytes());
+
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok || std::rename(tmpPath.c_str(), finalPath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool loadCached(const std::string& objPath, IndexedMesh& mesh, const ParseOptions& options) {
+    {
+        profile::ScopedTimer timer(profile::Phase::CacheRead);
+        if (readCache(objPath, mesh, options.attributes)) {
+            profile::add(profile::Counter::CacheHits, 1);
+            return true;
+        }
+    }
+    profile::add(profile::Counter::CacheMisses, 1);
+
+    if (!loadIndexed(objPath, mesh, options)) return false;
+
+    profile::ScopedTimer timer(profile::Phase::CacheWrite);
+    if (!writeCache(objPath, mesh, options.attributes)) {
+        std::cerr << "Aviso: não foi possível gravar o cache " << cachePath(objPath) << std::endl;
+    }
+
+    return true;
+}
+
+}
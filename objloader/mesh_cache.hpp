@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include "objloader.hpp"
+
+namespace objloader {
+
+// Cache binário de IndexedMesh gravado ao lado do OBJ ("<arquivo>.mcache").
+// A entrada é válida enquanto caminho absoluto, tamanho e mtime do OBJ não
+// mudarem; nesse caso os spans apontam direto para o arquivo mapeado.
+// O cabeçalho guarda com que atributos a malha foi montada, e um cache mais
+// completo que o pedido é aceito.
+std::string cachePath(const std::string& objPath);
+
+bool readCache(const std::string& objPath, IndexedMesh& mesh, unsigned attributes = AllAttributes);
+bool writeCache(const std::string& objPath, const IndexedMesh& mesh, unsigned attributes = AllAttributes);
+
+// Usa o cache se estiver atualizado; senão faz o parse e regrava o cache.
+bool loadCached(const std::string& objPath, IndexedMesh& mesh, const ParseOptions& options = {});
+
+}
@@ -0,0 +1,213 @@
+#include "obj_stream.hpp"
+#include "profile.hpp"
+#include "scan.hpp"
+#include "triangulate.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace objloader {
+
+using namespace scan;
+
+namespace {
+
+// Lê o arquivo em janelas e chama onLines(begin, end) só com linhas completas.
+// Uma linha maior que a janela faz o buffer crescer até caber. onLines
+// devolve false para interromper a leitura, que então falha.
+template <typename F>
+bool readWindows(const std::string& path, size_t windowBytes, F&& onLines) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Erro ao abrir arquivo: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<char> buffer(std::max<size_t>(windowBytes, 4096));
+    size_t carry = 0;
+
+    for (;;) {
+        size_t n = std::fread(buffer.data() + carry, 1, buffer.size() - carry, file);
+        size_t filled = carry + n;
+        bool eof = n == 0;
+        profile::add(profile::Counter::BytesRead, n);
+
+        if (eof) {
+            if (carry > 0 && !onLines(buffer.data(), buffer.data() + carry)) {
+                std::fclose(file);
+                return false;
+            }
+            break;
+        }
+
+        const char* begin = buffer.data();
+        const char* last = static_cast<const char*>(memrchr(begin, '\n', filled));
+
+        if (!last) {
+            if (filled == buffer.size()) buffer.resize(buffer.size() * 2);
+            carry = filled;
+            continue;
+        }
+
+        if (!onLines(begin, last + 1)) {
+            std::fclose(file);
+            return false;
+        }
+
+        carry = begin + filled - (last + 1);
+        std::memmove(buffer.data(), last + 1, carry);
+    }
+
+    bool ok = !std::ferror(file);
+    std::fclose(file);
+    return ok;
+}
+
+}
+
+bool streamPositions(const std::string& path, const StreamOptions& options, const PositionCallback& onPositions) {
+    profile::ScopedTimer timer(profile::Phase::Stream);
+    std::vector<glm::vec3> block;
+    block.reserve(std::max<size_t>(1, options.windowBytes / 32));
+    size_t delivered = 0;
+
+    return readWindows(path, options.windowBytes, [&](const char* p, const char* end) {
+        while (p < end) {
+            p = skipBlanks(p, end);
+            if (p < end - 1 && p[0] == 'v' && isBlank(p[1])) {
+                glm::vec3 pos;
+                p = parseFloat(p + 2, end, pos.x);
+                p = parseFloat(p, end, pos.y);
+                p = parseFloat(p, end, pos.z);
+                block.push_back(pos);
+            }
+            p = skipLine(p, end);
+        }
+
+        delivered += block.size();
+        if (options.windowBytes + delivered * sizeof(glm::vec3) > options.memoryLimit) {
+            std::cerr << "Posições passam do limite de memória (" << (options.memoryLimit >> 20) << " MB): "
+                      << path << std::endl;
+            return false;
+        }
+
+        if (!block.empty()) {
+            onPositions(block);
+            block.clear();
+        }
+        return true;
+    });
+}
+
+bool streamTriangles(const std::string& path, std::span<const glm::vec3> positions,
+                     const StreamOptions& options, const BatchCallback& onBatch) {
+    profile::ScopedTimer timer(profile::Phase::Stream);
+    constexpr size_t bytesPerTriangle = sizeof(std::array<unsigned, 3>) + 3 * sizeof(glm::vec3);
+    const size_t resident = options.windowBytes + positions.size_bytes();
+    const size_t budget = options.memoryLimit > resident ? options.memoryLimit - resident : 0;
+    if (budget < bytesPerTriangle) {
+        std::cerr << "Janela e posições não deixam espaço para triângulos no limite de memória ("
+                  << (options.memoryLimit >> 20) << " MB): " << path << std::endl;
+        return false;
+    }
+    const size_t capacity = budget / bytesPerTriangle;
+
+    std::vector<std::array<unsigned, 3>> indices;
+    std::vector<glm::vec3> corners;
+    indices.reserve(capacity);
+    corners.reserve(capacity * 3);
+
+    size_t first = 0;
+    size_t seenPositions = 0;
+    size_t skipped = 0;
+
+    auto flush = [&] {
+        if (indices.empty()) return;
+        onBatch(TriangleBatch{first, indices, corners});
+        first += indices.size();
+        indices.clear();
+        corners.clear();
+    };
+
+    auto emit = [&](unsigned a, unsigned b, unsigned c) {
+        indices.push_back({a, b, c});
+        corners.push_back(positions[a]);
+        corners.push_back(positions[b]);
+        corners.push_back(positions[c]);
+        if (indices.size() == capacity) flush();
+    };
+
+    // Face atual; polígonos côncavos passam pelo corte de orelhas
+    std::vector<unsigned> polygon;
+    std::vector<glm::vec3> points;
+    std::vector<std::array<unsigned, 3>> ears;
+
+    auto emitPolygon = [&] {
+        points.clear();
+        for (unsigned v : polygon) points.push_back(positions[v]);
+
+        if (isConvex(points)) {
+            for (size_t k = 1; k + 1 < polygon.size(); ++k) emit(polygon[0], polygon[k], polygon[k + 1]);
+            return;
+        }
+
+        earClip(points, ears);
+        for (const auto& tri : ears) emit(polygon[tri[0]], polygon[tri[1]], polygon[tri[2]]);
+    };
+
+    bool ok = readWindows(path, options.windowBytes, [&](const char* p, const char* end) {
+        while (p < end) {
+            p = skipBlanks(p, end);
+
+            if (p < end - 1 && isBlank(p[1])) {
+                if (p[0] == 'v') {
+                    // Só conta, para resolver índices negativos
+                    ++seenPositions;
+                }
+                else if (p[0] == 'f') {
+                    polygon.clear();
+                    bool valid = true;
+                    p += 2;
+
+                    for (;;) {
+                        p = skipBlanks(p, end);
+                        int idx;
+                        bool found;
+                        p = parseInt(p, end, idx, found);
+                        if (!found) break;
+
+                        int v = resolveIndex(idx, seenPositions);
+                        if (v < 0 || (size_t)v >= positions.size()) valid = false;
+                        polygon.push_back(v);
+
+                        // Ignora "/t/n"
+                        while (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') ++p;
+                    }
+
+                    if (valid && polygon.size() >= 3) {
+                        emitPolygon();
+                    }
+                    else {
+                        ++skipped;
+                    }
+                }
+            }
+
+            p = skipLine(p, end);
+        }
+        return true;
+    });
+
+    flush();
+
+    if (skipped) {
+        std::cerr << "Faces inválidas ignoradas: " << skipped << std::endl;
+    }
+
+    return ok;
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <span>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace objloader {
+
+struct StreamOptions {
+    // Tamanho de cada leitura do arquivo
+    size_t windowBytes{4u << 20};
+    // Teto para janela de leitura + posições + lote de triângulos em memória.
+    // As posições ficam todas residentes (os índices das faces apontam para
+    // qualquer uma), então o teto limita o tamanho de malha aceito.
+    size_t memoryLimit{64u << 20};
+};
+
+// Lote de triângulos entregue ao consumidor. Os spans só valem durante o callback.
+struct TriangleBatch {
+    size_t first;                                       // índice do 1º triângulo no arquivo
+    std::span<const std::array<unsigned, 3>> indices;   // posições em base 0
+    std::span<const glm::vec3> corners;                 // 3 posições por triângulo
+};
+
+using PositionCallback = std::function<void(std::span<const glm::vec3>)>;
+using BatchCallback = std::function<void(const TriangleBatch&)>;
+
+// Leitura do OBJ em janelas de tamanho fixo, sem carregar o arquivo inteiro.
+// Primeiro passo: entrega as posições ("v") em blocos, na ordem do arquivo.
+// Falha, sem entregar o resto, quando a janela mais as posições já entregues
+// (que o chamador guarda para o segundo passo) passam de options.memoryLimit.
+bool streamPositions(const std::string& path, const StreamOptions& options, const PositionCallback& onPositions);
+
+// Segundo passo: resolve as faces contra as posições já lidas e entrega os
+// triângulos em lotes do tamanho que sobra de options.memoryLimit depois da
+// janela e das posições; falha se não sobra nada. Faces de n cantos são
+// trianguladas como em parse().
+bool streamTriangles(const std::string& path, std::span<const glm::vec3> positions,
+                     const StreamOptions& options, const BatchCallback& onBatch);
+
+}
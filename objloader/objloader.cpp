@@ -0,0 +1,536 @@
+#include "objloader.hpp"
+#include "corner_map.hpp"
+#include "mapped_file.hpp"
+#include "profile.hpp"
+#include "scan.hpp"
+#include "thread_pool.hpp"
+#include "triangulate.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+
+namespace objloader {
+
+using namespace scan;
+
+namespace {
+
+// Índice negativo de um bloco paralelo que só pode ser resolvido depois que
+// se souber quantos atributos os blocos anteriores definiram.
+struct Fixup {
+    size_t corner;
+    int attr;
+    int local;
+};
+
+class Parser {
+    ObjData& out;
+    std::vector<Fixup>* fixups;
+    unsigned attributes;
+
+    // Cantos da face atual e seus índices pendentes (corner = posição na face),
+    // reaproveitados entre linhas
+    std::vector<Corner> polygon;
+    std::vector<Fixup> faceFixups;
+
+    // Contadores locais, somados ao profile no fim de run()
+    uint64_t lines{0};
+    uint64_t faces{0};
+    uint64_t faceCorners{0};
+
+public:
+    // Com fixups != nullptr os índices negativos ficam pendentes (modo bloco).
+    Parser(ObjData& data, std::vector<Fixup>* pending, unsigned mask)
+        : out(data), fixups(pending), attributes(mask) {}
+
+    void run(const char* p, const char* end);
+
+private:
+    int resolve(int idx, size_t count, size_t corner, int attr) {
+        if (idx < 0 && fixups) {
+            faceFixups.push_back({corner, attr, (int)count + idx});
+            return -2;
+        }
+        return resolveIndex(idx, count);
+    }
+
+    // Copia o canto j da face para out.corners, levando os índices pendentes
+    void emit(size_t j) {
+        if (fixups) {
+            for (const Fixup& fix : faceFixups) {
+                if (fix.corner == j) fixups->push_back({out.corners.size(), fix.attr, fix.local});
+            }
+        }
+        out.corners.push_back(polygon[j]);
+    }
+
+    // Triangulação em leque; faces com 4+ cantos são registradas para que
+    // triangulatePolygons refaça as côncavas quando as posições forem conhecidas.
+    void emitFace() {
+        const size_t n = polygon.size();
+        if (n < 3) return;
+
+        if (n > 3) out.polygons.push_back({out.corners.size(), (unsigned)n});
+
+        for (size_t k = 1; k + 1 < n; ++k) {
+            emit(0);
+            emit(k);
+            emit(k + 1);
+        }
+    }
+
+    // Resto da linha sem espaços nas pontas ("g", "usemtl", "mtllib").
+    static std::string readName(const char* p, const char* end) {
+        p = skipBlanks(p, end);
+        const char* stop = p;
+        while (stop < end && *stop != '\n' && *stop != '\r') ++stop;
+        while (stop > p && isBlank(stop[-1])) --stop;
+        return std::string(p, stop);
+    }
+
+    // "usemtl" e afins: palavra-chave seguida de espaço.
+    static bool startsWith(const char* p, const char* end, std::string_view keyword) {
+        return size_t(end - p) > keyword.size() && std::equal(keyword.begin(), keyword.end(), p) &&
+               isBlank(p[keyword.size()]);
+    }
+
+    // Lê "v", "v/t", "v//n" ou "v/t/n"; índices de atributos fora da máscara
+    // são pulados e ficam -1.
+    const char* parseCorner(const char* p, const char* end, size_t cornerIndex, Corner& corner, bool& found) {
+        int idx;
+        p = parseInt(p, end, idx, found);
+        if (!found) return p;
+        corner.v = resolve(idx, out.positions.size(), cornerIndex, 0);
+        corner.t = -1;
+        corner.n = -1;
+
+        if (p < end && *p == '/') {
+            bool has;
+            p = parseInt(p + 1, end, idx, has);
+            if (has && (attributes & Texcoords)) corner.t = resolve(idx, out.texcoords.size(), cornerIndex, 1);
+
+            if (p < end && *p == '/') {
+                p = parseInt(p + 1, end, idx, has);
+                if (has && (attributes & Normals)) corner.n = resolve(idx, out.normals.size(), cornerIndex, 2);
+            }
+        }
+
+        return p;
+    }
+};
+
+}
+
+void Parser::run(const char* p, const char* end) {
+    while (p < end) {
+        ++lines;
+        p = skipBlanks(p, end);
+        if (p == end) break;
+
+        const char c = *p;
+        const char next = p + 1 < end ? p[1] : '\n';
+
+        if (c == 'v') {
+            if (isBlank(next)) {
+                if (attributes & Positions) {
+                    glm::vec3 pos;
+                    p = parseFloat(p + 2, end, pos.x);
+                    p = parseFloat(p, end, pos.y);
+                    p = parseFloat(p, end, pos.z);
+                    out.positions.push_back(pos);
+                }
+            }
+            else if (next == 'n' && p + 2 < end && isBlank(p[2]) && (attributes & Normals)) {
+                glm::vec3 norm;
+                p = parseFloat(p + 3, end, norm.x);
+                p = parseFloat(p, end, norm.y);
+                p = parseFloat(p, end, norm.z);
+                out.normals.push_back(norm);
+            }
+            else if (next == 't' && p + 2 < end && isBlank(p[2]) && (attributes & Texcoords)) {
+                glm::vec2 uv;
+                p = parseFloat(p + 3, end, uv.x);
+                p = parseFloat(p, end, uv.y);
+                out.texcoords.push_back(uv);
+            }
+        }
+        else if (c == 'f' && isBlank(next) && (attributes & Positions)) {
+            polygon.clear();
+            faceFixups.clear();
+            p += 2;
+
+            for (;;) {
+                p = skipBlanks(p, end);
+                Corner corner;
+                bool found;
+                p = parseCorner(p, end, polygon.size(), corner, found);
+                if (!found) break;
+                polygon.push_back(corner);
+            }
+
+            ++faces;
+            faceCorners += polygon.size();
+            emitFace();
+        }
+        else if (c == 'g' && isBlank(next) && (attributes & Groups)) {
+            out.groups.push_back({readName(p + 2, end), out.corners.size()});
+        }
+        else if (c == 'u' && (attributes & Materials) && startsWith(p, end, "usemtl")) {
+            out.materials.push_back({readName(p + 7, end), out.corners.size()});
+        }
+        else if (c == 'm' && (attributes & Materials) && startsWith(p, end, "mtllib")) {
+            out.materialLibraries.push_back(readName(p + 7, end));
+        }
+
+        p = skipLine(p, end);
+    }
+
+    profile::add(profile::Counter::Lines, lines);
+    profile::add(profile::Counter::Faces, faces);
+    profile::add(profile::Counter::Corners, faceCorners);
+}
+
+void parseBuffer(const char* begin, const char* end, ObjData& out, unsigned attributes) {
+    Parser(out, nullptr, attributes).run(begin, end);
+}
+
+namespace {
+
+struct Chunk {
+    ObjData data;
+    std::vector<Fixup> fixups;
+};
+
+// Divide [begin, end) em até count blocos terminados em quebra de linha.
+std::vector<std::pair<const char*, const char*>> splitLines(const char* begin, const char* end, size_t count) {
+    std::vector<std::pair<const char*, const char*>> ranges;
+    const size_t step = (end - begin) / count + 1;
+
+    const char* start = begin;
+    while (start < end) {
+        const char* stop = start + std::min<size_t>(step, end - start);
+        stop = skipLine(stop == start ? stop : stop - 1, end);
+        ranges.emplace_back(start, stop);
+        start = stop;
+    }
+
+    return ranges;
+}
+
+template <typename T>
+void append(std::vector<T>& dst, size_t offset, const std::vector<T>& src) {
+    std::copy(src.begin(), src.end(), dst.begin() + offset);
+}
+
+// Mesmo que append, deslocando firstCorner para a numeração final
+void appendRanges(std::vector<NamedRange>& dst, size_t offset, std::vector<NamedRange>& src, size_t corners) {
+    for (size_t k = 0; k < src.size(); ++k) {
+        dst[offset + k] = {std::move(src[k].name), src[k].firstCorner + corners};
+    }
+}
+
+}
+
+void parseParallel(const char* begin, const char* end, ObjData& out, ThreadPool& pool, unsigned attributes) {
+    auto ranges = splitLines(begin, end, size_t(pool.size()) * 4);
+    std::vector<Chunk> chunks(ranges.size());
+
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        Parser(chunks[i].data, &chunks[i].fixups, attributes).run(ranges[i].first, ranges[i].second);
+    });
+
+    // Deslocamento de cada bloco no resultado final (prefixos por atributo)
+    struct Offsets { size_t positions, texcoords, normals, corners, polygons, groups, materials; };
+    std::vector<Offsets> offsets(chunks.size() + 1);
+    offsets[0] = {out.positions.size(), out.texcoords.size(), out.normals.size(), out.corners.size(),
+                  out.polygons.size(), out.groups.size(), out.materials.size()};
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const ObjData& d = chunks[i].data;
+        offsets[i + 1] = {
+            offsets[i].positions + d.positions.size(),
+            offsets[i].texcoords + d.texcoords.size(),
+            offsets[i].normals + d.normals.size(),
+            offsets[i].corners + d.corners.size(),
+            offsets[i].polygons + d.polygons.size(),
+            offsets[i].groups + d.groups.size(),
+            offsets[i].materials + d.materials.size()
+        };
+    }
+
+    out.positions.resize(offsets.back().positions);
+    out.texcoords.resize(offsets.back().texcoords);
+    out.normals.resize(offsets.back().normals);
+    out.corners.resize(offsets.back().corners);
+    out.polygons.resize(offsets.back().polygons);
+    out.groups.resize(offsets.back().groups);
+    out.materials.resize(offsets.back().materials);
+
+    // Poucas e pequenas: juntadas em série antes da cópia paralela
+    for (Chunk& chunk : chunks) {
+        auto& libraries = chunk.data.materialLibraries;
+        std::move(libraries.begin(), libraries.end(), std::back_inserter(out.materialLibraries));
+    }
+
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        Chunk& chunk = chunks[i];
+        const Offsets& o = offsets[i];
+
+        append(out.positions, o.positions, chunk.data.positions);
+        append(out.texcoords, o.texcoords, chunk.data.texcoords);
+        append(out.normals, o.normals, chunk.data.normals);
+        append(out.corners, o.corners, chunk.data.corners);
+
+        for (size_t k = 0; k < chunk.data.polygons.size(); ++k) {
+            Polygon poly = chunk.data.polygons[k];
+            poly.firstCorner += o.corners;
+            out.polygons[o.polygons + k] = poly;
+        }
+
+        appendRanges(out.groups, o.groups, chunk.data.groups, o.corners);
+        appendRanges(out.materials, o.materials, chunk.data.materials, o.corners);
+
+        const size_t prefix[3] = {o.positions, o.texcoords, o.normals};
+        for (const Fixup& fix : chunk.fixups) {
+            long long absolute = (long long)prefix[fix.attr] + fix.local;
+            int value = absolute >= 0 ? (int)absolute : -2;
+
+            Corner& c = out.corners[o.corners + fix.corner];
+            (fix.attr == 0 ? c.v : fix.attr == 1 ? c.t : c.n) = value;
+        }
+
+        chunk = Chunk();
+    });
+}
+
+void triangulatePolygons(ObjData& data) {
+    std::vector<Corner> corners;
+    std::vector<glm::vec3> points;
+    std::vector<std::array<unsigned, 3>> triangles;
+
+    for (const Polygon& poly : data.polygons) {
+        // Recupera a ordem original a partir do leque (0, k, k + 1)
+        const Corner* fan = data.corners.data() + poly.firstCorner;
+        corners.assign({fan[0], fan[1], fan[2]});
+        for (unsigned k = 1; k + 2 < poly.size; ++k) {
+            corners.push_back(fan[3 * k + 2]);
+        }
+
+        points.clear();
+        bool valid = true;
+        for (const Corner& c : corners) {
+            if (c.v < 0 || (size_t)c.v >= data.positions.size()) {
+                valid = false;
+                break;
+            }
+            points.push_back(data.positions[c.v]);
+        }
+
+        if (!valid || isConvex(points)) continue;
+
+        earClip(points, triangles);
+
+        Corner* out = data.corners.data() + poly.firstCorner;
+        for (const auto& tri : triangles) {
+            *out++ = corners[tri[0]];
+            *out++ = corners[tri[1]];
+            *out++ = corners[tri[2]];
+        }
+    }
+}
+
+namespace {
+
+// Acompanha a compactação de validate(): ranges que começam até read passam a
+// começar em write.
+struct RangeRemap {
+    std::vector<NamedRange>& ranges;
+    size_t next{0};
+
+    void advance(size_t read, size_t write) {
+        while (next < ranges.size() && ranges[next].firstCorner <= read) {
+            ranges[next++].firstCorner = write;
+        }
+    }
+};
+
+}
+
+size_t validate(ObjData& data) {
+    const int numPositions = (int)data.positions.size();
+    const int numTexcoords = (int)data.texcoords.size();
+    const int numNormals = (int)data.normals.size();
+
+    size_t write = 0;
+    size_t removed = 0;
+    size_t nextPolygon = 0;
+    size_t keptPolygons = 0;
+    RangeRemap groups{data.groups};
+    RangeRemap materials{data.materials};
+
+    // Uma face é um triângulo ou, se listada em polygons, todo o seu leque
+    for (size_t read = 0; read + 2 < data.corners.size();) {
+        size_t count = 3;
+        unsigned polygonSize = 0;
+        if (nextPolygon < data.polygons.size() && data.polygons[nextPolygon].firstCorner == read) {
+            polygonSize = data.polygons[nextPolygon++].size;
+            count = 3 * (polygonSize - 2);
+        }
+
+        groups.advance(read, write);
+        materials.advance(read, write);
+
+        bool valid = true;
+        for (size_t i = read; i < read + count; ++i) {
+            Corner& c = data.corners[i];
+            if (c.v < 0 || c.v >= numPositions) valid = false;
+            if (c.t >= numTexcoords || c.t < -1) c.t = -1;
+            if (c.n >= numNormals || c.n < -1) c.n = -1;
+        }
+
+        if (valid) {
+            if (polygonSize) data.polygons[keptPolygons++] = {write, polygonSize};
+            if (write != read) {
+                std::copy(data.corners.begin() + read, data.corners.begin() + read + count, data.corners.begin() + write);
+            }
+            write += count;
+        }
+        else {
+            ++removed;
+        }
+
+        read += count;
+    }
+
+    groups.advance(data.corners.size(), write);
+    materials.advance(data.corners.size(), write);
+
+    data.corners.resize(write);
+    data.polygons.resize(keptPolygons);
+    return removed;
+}
+
+bool parse(const std::string& path, ObjData& out, const ParseOptions& options) {
+    MappedFile file;
+    {
+        profile::ScopedTimer timer(profile::Phase::Read);
+        if (!file.open(path)) {
+            std::cerr << "Erro ao abrir arquivo: " << path << std::endl;
+            return false;
+        }
+    }
+    profile::add(profile::Counter::BytesRead, file.size());
+
+    {
+        profile::ScopedTimer timer(profile::Phase::Tokenize);
+        ThreadPool& pool = ThreadPool::shared();
+        if (options.parallel && pool.size() > 1 && file.size() >= options.parallelThreshold) {
+            parseParallel(file.data(), file.end(), out, pool, options.attributes);
+        }
+        else {
+            parseBuffer(file.data(), file.end(), out, options.attributes);
+        }
+    }
+
+    {
+        profile::ScopedTimer timer(profile::Phase::Triangulate);
+        triangulatePolygons(out);
+    }
+
+    profile::ScopedTimer timer(profile::Phase::Validate);
+    if (size_t removed = validate(out)) {
+        std::cerr << "Faces com índice fora do intervalo ignoradas: " << removed << std::endl;
+    }
+
+    return true;
+}
+
+void buildIndexed(const ObjData& data, MeshBuffers& mesh, unsigned attributes) {
+    const bool withNormals = attributes & Normals;
+    const size_t firstVertex = mesh.vertices.size();
+    const size_t firstTriangle = mesh.triangles.size();
+
+    {
+        profile::ScopedTimer timer(profile::Phase::Dedup);
+
+        // O parse já contou as faces: estima os cantos distintos sem precisar crescer
+        CornerMap index_map(std::max(data.positions.size(), data.triangleCount() / 2));
+
+        mesh.triangles.reserve(mesh.triangles.size() + data.triangleCount());
+
+        for (size_t f = 0; f + 2 < data.corners.size(); f += 3) {
+            std::array<unsigned, 3> tri;
+
+            for (int i = 0; i < 3; ++i) {
+                const Corner& c = data.corners[f + i];
+                auto [index, inserted] = index_map.tryEmplace(c, (unsigned)mesh.vertices.size());
+
+                if (inserted) {
+                    mesh.vertices.push_back(data.positions[c.v]);
+                    if (withNormals) mesh.normals.push_back(c.n >= 0 ? data.normals[c.n] : glm::vec3(0.0f));
+                }
+
+                tri[i] = index;
+            }
+
+            mesh.triangles.push_back(tri);
+        }
+
+        profile::add(profile::Counter::UniqueCorners, index_map.size());
+        profile::add(profile::Counter::HashProbes, index_map.probes());
+    }
+
+    if (!withNormals) return;
+
+    profile::ScopedTimer timer(profile::Phase::Normals);
+
+    for (size_t i = firstVertex; i < mesh.normals.size(); ++i) {
+        if (mesh.normals[i] != glm::vec3(0.0f)) mesh.normals[i] = glm::normalize(mesh.normals[i]);
+    }
+
+    // Na ordem das faces: só recebe a normal da face o triângulo cujos três
+    // vértices ainda não têm normal
+    for (size_t f = firstTriangle; f < mesh.triangles.size(); ++f) {
+        const auto& tri = mesh.triangles[f];
+
+        if (mesh.normals[tri[0]] == glm::vec3(0.0f) &&
+            mesh.normals[tri[1]] == glm::vec3(0.0f) &&
+            mesh.normals[tri[2]] == glm::vec3(0.0f)) {
+
+            glm::vec3 v0 = mesh.vertices[tri[0]];
+            glm::vec3 v1 = mesh.vertices[tri[1]];
+            glm::vec3 v2 = mesh.vertices[tri[2]];
+
+            glm::vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+
+            mesh.normals[tri[0]] = normal;
+            mesh.normals[tri[1]] = normal;
+            mesh.normals[tri[2]] = normal;
+        }
+    }
+}
+
+bool loadIndexed(const std::string& path, IndexedMesh& mesh, const ParseOptions& options) {
+    ObjData data;
+    if (!parse(path, data, options)) return false;
+
+    MeshBuffers buffers;
+    buildIndexed(data, buffers, options.attributes);
+    mesh = IndexedMesh::fromBuffers(std::move(buffers));
+    return true;
+}
+
+IndexedMesh IndexedMesh::fromBuffers(MeshBuffers&& buffers) {
+    auto owned = std::make_shared<MeshBuffers>(std::move(buffers));
+
+    IndexedMesh mesh;
+    mesh.vertices = owned->vertices;
+    mesh.normals = owned->normals;
+    mesh.triangles = owned->triangles;
+    mesh.storage = std::move(owned);
+    return mesh;
+}
+
+}
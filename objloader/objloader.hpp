@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace objloader {
+
+class ThreadPool;
+
+// Registros que o parser deve ler; os demais são pulados sem conversão.
+// Sem Positions as faces também são ignoradas.
+enum Attribute : unsigned {
+    Positions = 1u << 0,
+    Normals = 1u << 1,
+    Texcoords = 1u << 2,
+    Groups = 1u << 3,
+    Materials = 1u << 4,
+    AllAttributes = Positions | Normals | Texcoords | Groups | Materials
+};
+
+struct ParseOptions {
+    // Divide o arquivo em blocos processados no ThreadPool::shared()
+    bool parallel{true};
+    // Arquivos menores que isso são lidos numa thread só
+    size_t parallelThreshold{8u << 20};
+    // Máscara de Attribute; só posições basta para colisão
+    unsigned attributes{AllAttributes};
+};
+
+// Canto de face com índices já resolvidos para base 0 (negativos inclusive).
+// t e n valem -1 quando ausentes.
+struct Corner {
+    int v{-1};
+    int t{-1};
+    int n{-1};
+
+    bool operator==(const Corner&) const = default;
+};
+
+// Face de 4+ cantos: ocupa 3 * (size - 2) cantos a partir de firstCorner.
+struct Polygon {
+    size_t firstCorner;
+    unsigned size;
+};
+
+// Início de um grupo ("g") ou material ("usemtl"), válido até o próximo
+// registro do mesmo tipo.
+struct NamedRange {
+    std::string name;
+    size_t firstCorner;
+};
+
+// Conteúdo bruto do OBJ: atributos na ordem do arquivo e 3 cantos por triângulo.
+// Faces com mais cantos chegam trianguladas e ficam listadas em polygons.
+struct ObjData {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texcoords;
+    std::vector<glm::vec3> normals;
+    std::vector<Corner> corners;
+    std::vector<Polygon> polygons;
+    std::vector<NamedRange> groups;
+    std::vector<NamedRange> materials;
+    std::vector<std::string> materialLibraries;
+
+    size_t triangleCount() const { return corners.size() / 3; }
+};
+
+// Malha indexada: um vértice por canto distinto (v/t/n), normais normalizadas
+// e normal da face para os cantos sem "vn". Sem Normals, normals fica vazio.
+struct MeshBuffers {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<std::array<unsigned, 3>> triangles;
+};
+
+// Visão somente leitura de uma malha indexada. Os spans apontam para a memória
+// mantida viva por storage: um MeshBuffers próprio ou o cache binário mapeado.
+struct IndexedMesh {
+    std::span<const glm::vec3> vertices;
+    std::span<const glm::vec3> normals;
+    std::span<const std::array<unsigned, 3>> triangles;
+    std::shared_ptr<const void> storage;
+
+    static IndexedMesh fromBuffers(MeshBuffers&& buffers);
+};
+
+// Lê registros v, vt, vn, f, g, usemtl e mtllib de um arquivo mapeado em
+// memória, conforme options.attributes.
+bool parse(const std::string& path, ObjData& out, const ParseOptions& options = {});
+
+// Mesmo parser sobre um buffer já em memória. Faces de n cantos saem em leque;
+// triangulatePolygons corrige as côncavas.
+void parseBuffer(const char* begin, const char* end, ObjData& out, unsigned attributes = AllAttributes);
+
+// Versão paralela: separa o buffer em quebras de linha, processa cada bloco no
+// pool e junta na ordem do arquivo, resolvendo índices negativos entre blocos.
+void parseParallel(const char* begin, const char* end, ObjData& out, ThreadPool& pool,
+                   unsigned attributes = AllAttributes);
+
+// Refaz por corte de orelhas os polígonos não convexos de data.polygons.
+// parse() já chama esta função.
+void triangulatePolygons(ObjData& data);
+
+// Remove as faces com índice de posição inválido e descarta t/n fora do intervalo.
+// Retorna o número de faces removidas.
+size_t validate(ObjData& data);
+
+void buildIndexed(const ObjData& data, MeshBuffers& mesh, unsigned attributes = AllAttributes);
+
+bool loadIndexed(const std::string& path, IndexedMesh& mesh, const ParseOptions& options = {});
+
+}
@@ -0,0 +1,129 @@
+#include "profile.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace objloader::profile {
+
+namespace {
+
+constexpr size_t phaseCount = size_t(Phase::Count);
+constexpr size_t counterCount = size_t(Counter::Count);
+
+constexpr const char* phaseNames[phaseCount] = {
+    "read", "tokenize", "triangulate", "validate", "dedup", "normals",
+    "weld", "cache_read", "cache_write", "stream", "tree_build", "tree_read", "tree_write"
+};
+
+constexpr const char* counterNames[counterCount] = {
+    "bytes_read", "lines", "faces", "corners", "unique_corners",
+    "hash_probes", "cache_hits", "cache_misses"
+};
+
+std::atomic<bool> active{false};
+std::atomic<uint64_t> phaseNanos[phaseCount];
+std::atomic<uint64_t> phaseCalls[phaseCount];
+std::atomic<uint64_t> counters[counterCount];
+
+bool printTable = false;
+std::string jsonPath;
+
+void reportAtExit() {
+    if (printTable) report(std::cerr);
+
+    if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        if (file) reportJson(file);
+        else std::cerr << "Erro ao gravar " << jsonPath << std::endl;
+    }
+}
+
+}
+
+bool enabled() {
+    return active.load(std::memory_order_relaxed);
+}
+
+void add(Counter counter, uint64_t value) {
+    counters[size_t(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void addTime(Phase phase, std::chrono::nanoseconds elapsed) {
+    phaseNanos[size_t(phase)].fetch_add(elapsed.count(), std::memory_order_relaxed);
+    phaseCalls[size_t(phase)].fetch_add(1, std::memory_order_relaxed);
+}
+
+int init(int argc, char** argv) {
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--profile") == 0) {
+            printTable = true;
+        }
+        else if (std::strncmp(argv[i], "--profile-json=", 15) == 0) {
+            jsonPath = argv[i] + 15;
+        }
+        else {
+            argv[kept++] = argv[i];
+        }
+    }
+
+    if (kept < argc) argv[kept] = nullptr;
+
+    if ((printTable || !jsonPath.empty()) && !active.exchange(true)) {
+        std::atexit(reportAtExit);
+    }
+
+    return kept;
+}
+
+void report(std::ostream& out) {
+    const auto flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+
+    out << std::left << std::setw(12) << "fase" << std::right << std::setw(10) << "ms"
+        << std::setw(12) << "chamadas" << '\n';
+    for (size_t i = 0; i < phaseCount; ++i) {
+        uint64_t calls = phaseCalls[i].load();
+        if (calls == 0) continue;
+        out << std::left << std::setw(12) << phaseNames[i] << std::right
+            << std::setw(10) << phaseNanos[i].load() / 1e6 << std::setw(12) << calls << '\n';
+    }
+
+    out << '\n' << std::left << std::setw(16) << "contador" << std::right << std::setw(16) << "valor" << '\n';
+    for (size_t i = 0; i < counterCount; ++i) {
+        out << std::left << std::setw(16) << counterNames[i] << std::right
+            << std::setw(16) << counters[i].load() << '\n';
+    }
+
+    out.flags(flags);
+}
+
+void reportJson(std::ostream& out) {
+    const auto flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\n  \"phases\": {";
+    const char* separator = "\n";
+    for (size_t i = 0; i < phaseCount; ++i) {
+        out << separator << "    \"" << phaseNames[i] << "\": {\"ms\": " << phaseNanos[i].load() / 1e6
+            << ", \"calls\": " << phaseCalls[i].load() << "}";
+        separator = ",\n";
+    }
+
+    out << "\n  },\n  \"counters\": {";
+    separator = "\n";
+    for (size_t i = 0; i < counterCount; ++i) {
+        out << separator << "    \"" << counterNames[i] << "\": " << counters[i].load();
+        separator = ",\n";
+    }
+    out << "\n  }\n}\n";
+
+    out.flags(flags);
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+// Tempos por fase e contadores do carregamento. Fica desligado até init()
+// encontrar a opção na linha de comando; desligado, ScopedTimer não lê o
+// relógio e os contadores custam um incremento atômico por chamada.
+namespace objloader::profile {
+
+enum class Phase {
+    Read,           // abrir e mapear o arquivo
+    Tokenize,       // parse das linhas (inclui as faltas de página do mmap)
+    Triangulate,
+    Validate,
+    Dedup,          // cantos v/t/n -> vértices indexados
+    Normals,
+    Weld,
+    CacheRead,
+    CacheWrite,
+    Stream,         // leitura em janelas do lab03, callbacks inclusos
+    TreeBuild,
+    TreeRead,       // árvores de colisão gravadas (.bvh)
+    TreeWrite,
+    Count
+};
+
+enum class Counter {
+    BytesRead,
+    Lines,
+    Faces,
+    Corners,
+    UniqueCorners,
+    HashProbes,
+    CacheHits,
+    CacheMisses,
+    Count
+};
+
+bool enabled();
+
+void add(Counter counter, uint64_t value);
+void addTime(Phase phase, std::chrono::nanoseconds elapsed);
+
+class ScopedTimer {
+    Phase phase;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(Phase p) : phase(p), active(enabled()) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() {
+        if (active) addTime(phase, std::chrono::steady_clock::now() - start);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Retira de argv "--profile" (tabela em stderr ao sair) e
+// "--profile-json=<arquivo>" (JSON gravado ao sair) e devolve o novo argc.
+int init(int argc, char** argv);
+
+void report(std::ostream& out);
+void reportJson(std::ostream& out);
+
+}
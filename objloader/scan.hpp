@@ -0,0 +1,74 @@
+#pragma once
+
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include "simd_scan.hpp"
+
+// Funções de varredura de texto compartilhadas pelos parsers do OBJ.
+namespace objloader::scan {
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    return simd::skipBlanks(p, end);
+}
+
+inline const char* skipLine(const char* p, const char* end) {
+    const char* nl = simd::findNewline(p, end);
+    return nl < end ? nl + 1 : end;
+}
+
+inline const char* parseFloat(const char* p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    if (const char* q = simd::parseFloatFast(p, end, value)) return q;
+
+    if (p < end && *p == '+') ++p;
+
+    auto [ptr, ec] = std::from_chars(p, end, value);
+    if (ec == std::errc::invalid_argument) {
+        value = 0.0f;
+        return p;
+    }
+    // Fora do intervalo (subnormais): o ponteiro avança mesmo assim
+    if (ec == std::errc::result_out_of_range) value = 0.0f;
+    return ptr;
+}
+
+// Um número maior que INT_MAX é lido até o fim mas vira 0, que
+// resolveIndex trata como índice inválido.
+inline const char* parseInt(const char* p, const char* end, int& value, bool& found) {
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+
+    const char* start = p;
+    long long result = 0;
+    bool overflow = false;
+    while (p < end && unsigned(*p - '0') < 10) {
+        if (!overflow) {
+            result = result * 10 + (*p - '0');
+            overflow = result > INT_MAX;
+        }
+        ++p;
+    }
+
+    found = p != start;
+    if (overflow) result = 0;
+    value = negative ? -(int)result : (int)result;
+    return p;
+}
+
+// Converte um índice do OBJ (base 1 ou negativo relativo) para base 0.
+// Zero e referências antes do início do arquivo viram -2 (inválido).
+inline int resolveIndex(int idx, size_t count) {
+    if (idx > 0) return idx - 1;
+    if (idx < 0 && (long long)count + idx >= 0) return (int)count + idx;
+    return -2;
+}
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Tokenizador vetorizado dos campos numéricos do OBJ: busca de quebra de linha
+// e de fim de espaços 32 bytes por vez (AVX2, ou 2x SSE2) e um parser decimal
+// rápido com volta para std::from_chars quando o atalho não é exato.
+namespace objloader::simd {
+
+// Máscara de 32 bits com os bytes de [p, p + 32) iguais a c.
+inline uint32_t matchMask32(const char* p, char c) {
+#if defined(__AVX2__)
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c)));
+#elif defined(__SSE2__)
+    __m128i needle = _mm_set1_epi8(c);
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, needle)) |
+           (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, needle)) << 16;
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < 32; ++i) mask |= uint32_t(p[i] == c) << i;
+    return mask;
+#endif
+}
+
+// Máscara dos bytes de [p, p + 32) que NÃO são ' ' nem '\t'.
+inline uint32_t nonBlankMask32(const char* p) {
+#if defined(__AVX2__)
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                                    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+    return ~(uint32_t)_mm256_movemask_epi8(blank);
+#elif defined(__SSE2__)
+    auto blank16 = [](const char* q) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+        return (uint32_t)_mm_movemask_epi8(blank);
+    };
+    return ~(blank16(p) | blank16(p + 16) << 16);
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < 32; ++i) mask |= uint32_t(p[i] != ' ' && p[i] != '\t') << i;
+    return mask;
+#endif
+}
+
+// Primeira ocorrência de '\n' em [p, end), ou end.
+inline const char* findNewline(const char* p, const char* end) {
+    while (end - p >= 32) {
+        if (uint32_t mask = matchMask32(p, '\n')) return p + std::countr_zero(mask);
+        p += 32;
+    }
+    const void* nl = std::memchr(p, '\n', end - p);
+    return nl ? static_cast<const char*>(nl) : end;
+}
+
+// Primeiro byte de [p, end) que não é espaço nem tabulação.
+inline const char* skipBlanks(const char* p, const char* end) {
+    // Quase sempre há no máximo um separador: resolve sem carregar 32 bytes
+    if (p < end && *p != ' ' && *p != '\t') return p;
+    if (end - p > 1 && p[1] != ' ' && p[1] != '\t') return p + 1;
+
+    while (end - p >= 32) {
+        if (uint32_t mask = nonBlankMask32(p)) return p + std::countr_zero(mask);
+        p += 32;
+    }
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+// Converte 8 dígitos ASCII de uma vez (SWAR). Falso se algum byte não é dígito.
+inline bool parseEightDigits(const char* p, uint64_t& value) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+
+    if ((((chunk & 0xf0f0f0f0f0f0f0f0) | (((chunk + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4))) !=
+        0x3333333333333333) {
+        return false;
+    }
+
+    chunk -= 0x3030303030303030;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = (((chunk & 0x000000ff000000ff) * (100 + (1000000ull << 32))) +
+             (((chunk >> 16) & 0x000000ff000000ff) * (1 + (10000ull << 32)))) >> 32;
+    value = chunk;
+    return true;
+}
+
+// Acumula dígitos em mantissa; retorna o fim da sequência e soma em count.
+inline const char* parseDigits(const char* q, const char* end, uint64_t& mantissa, int& count) {
+    uint64_t eight;
+    while (end - q >= 8 && count <= 11 && parseEightDigits(q, eight)) {
+        mantissa = mantissa * 100000000 + eight;
+        count += 8;
+        q += 8;
+    }
+    while (q < end && unsigned(*q - '0') < 10) {
+        mantissa = mantissa * 10 + unsigned(*q - '0');
+        ++count;
+        ++q;
+    }
+    return q;
+}
+
+// Atalho para decimais sem expoente com até 19 dígitos significativos, o
+// formato de "%.6f" e afins. Com mantissa <= 2^53 e até 22 casas, m / 10^k em
+// double é o arredondamento correto; a conversão para float só pode errar se o
+// double cair exatamente no meio de dois floats, caso em que desistimos.
+// Retorna nullptr quando o texto precisa do caminho exato.
+inline const char* parseFloatFast(const char* p, const char* end, float& value) {
+    static constexpr double pow10[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* q = p;
+    bool negative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+        negative = *q == '-';
+        ++q;
+    }
+
+    const char* start = q;
+    while (q < end && *q == '0') ++q;
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    q = parseDigits(q, end, mantissa, digits);
+    const bool hasInteger = q != start;
+
+    int fraction = 0;
+    if (q < end && *q == '.') {
+        const char* fracStart = ++q;
+        if (mantissa == 0) {
+            while (q < end && *q == '0') ++q;
+        }
+        q = parseDigits(q, end, mantissa, digits);
+        fraction = int(q - fracStart);
+        if (!hasInteger && fraction == 0) return nullptr;
+    }
+    else if (!hasInteger) {
+        return nullptr;
+    }
+
+    if (q < end && (*q == 'e' || *q == 'E')) return nullptr;
+    if (digits > 19 || fraction > 22 || mantissa > (uint64_t(1) << 53)) return nullptr;
+
+    double d = double(mantissa) / pow10[fraction];
+    if (d != 0.0 && (d < 1.17549435e-38 || d > 3.40282347e38)) return nullptr;
+
+    const uint64_t bits = std::bit_cast<uint64_t>(d);
+    if ((bits & 0x1fffffff) == 0x10000000) return nullptr;
+
+    value = negative ? -float(d) : float(d);
+    return q;
+}
+
+}
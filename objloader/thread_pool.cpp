@@ -0,0 +1,119 @@
+#include "thread_pool.hpp"
+
+namespace objloader {
+
+namespace {
+
+// Pool e fila da thread atual quando ela é um worker
+thread_local ThreadPool* currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+
+}
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i <= threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    const size_t index = currentPool == this ? currentQueue : workers.size();
+
+    // Conta antes de publicar para que queued nunca fique abaixo do real
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++queued;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+bool ThreadPool::runOne() {
+    std::function<void()> task;
+    const size_t count = queues.size();
+    const size_t own = currentPool == this ? currentQueue : count - 1;
+
+    // Própria fila pelo fim (LIFO), as demais pelo início
+    for (size_t k = 0; k < count && !task; ++k) {
+        Queue& queue = *queues[(own + k) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+
+        if (k == 0 && own != count - 1) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task) return false;
+
+    --queued;
+    task();
+    return true;
+}
+
+void ThreadPool::wait(std::future<void>& result) {
+    while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (!runOne()) std::this_thread::yield();
+    }
+    result.get();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    std::vector<std::future<void>> pending;
+    pending.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        pending.push_back(submit([&fn, i] { fn(i); }));
+    }
+
+    for (auto& f : pending) {
+        wait(f);
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentQueue = index;
+
+    for (;;) {
+        if (runOne()) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        cv.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
+
+}
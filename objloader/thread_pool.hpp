@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace objloader {
+
+// Pool fixo de threads com roubo de tarefas: cada worker tem sua fila, de
+// onde tira as tarefas mais novas, e rouba as mais antigas das outras quando
+// a sua esvazia. Tarefas enviadas de fora do pool vão para uma fila comum.
+// wait() executa outras tarefas enquanto espera, então tarefas podem criar e
+// esperar subtarefas sem travar o pool.
+class ThreadPool {
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;     // uma por worker + a comum no fim
+    std::atomic<size_t> queued{0};                  // tarefas ainda nas filas
+    std::mutex sleepMutex;
+    std::condition_variable cv;
+    bool stopping{false};
+
+public:
+    // threads == 0 usa std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers.size(); }
+
+    template <typename F>
+    std::future<void> submit(F&& task) {
+        auto packaged = std::make_shared<std::packaged_task<void()>>(std::forward<F>(task));
+        std::future<void> result = packaged->get_future();
+        push([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    // Espera result executando tarefas pendentes enquanto isso.
+    void wait(std::future<void>& result);
+
+    // Executa fn(i) para i em [0, count) e espera todas terminarem.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    // Pool compartilhado do processo, criado sob demanda.
+    static ThreadPool& shared();
+
+private:
+    void push(std::function<void()> task);
+    bool runOne();
+    void workerLoop(size_t index);
+};
+
+}
@@ -0,0 +1,107 @@
+#include "triangulate.hpp"
+
+#include <cmath>
+
+namespace objloader {
+
+namespace {
+
+// Eixos do plano onde o polígono tem maior área (normal de Newell)
+std::pair<int, int> projectionAxes(std::span<const glm::vec3> points) {
+    glm::vec3 normal(0.0f);
+    for (size_t i = 0; i < points.size(); ++i) {
+        const glm::vec3& a = points[i];
+        const glm::vec3& b = points[(i + 1) % points.size()];
+        normal.x += (a.y - b.y) * (a.z + b.z);
+        normal.y += (a.z - b.z) * (a.x + b.x);
+        normal.z += (a.x - b.x) * (a.y + b.y);
+    }
+
+    glm::vec3 n = glm::abs(normal);
+    if (n.x >= n.y && n.x >= n.z) return normal.x >= 0 ? std::pair{1, 2} : std::pair{2, 1};
+    if (n.y >= n.z) return normal.y >= 0 ? std::pair{2, 0} : std::pair{0, 2};
+    return normal.z >= 0 ? std::pair{0, 1} : std::pair{1, 0};
+}
+
+// Projeção com orientação anti-horária
+std::vector<glm::vec2> project(std::span<const glm::vec3> points) {
+    auto [u, v] = projectionAxes(points);
+    std::vector<glm::vec2> flat;
+    flat.reserve(points.size());
+    for (const auto& p : points) {
+        flat.emplace_back(p[u], p[v]);
+    }
+    return flat;
+}
+
+float cross(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+bool insideTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+    return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+}
+
+}
+
+bool isConvex(std::span<const glm::vec3> points) {
+    if (points.size() <= 3) return true;
+
+    std::vector<glm::vec2> flat = project(points);
+    const size_t n = flat.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (cross(flat[i], flat[(i + 1) % n], flat[(i + 2) % n]) < 0) return false;
+    }
+    return true;
+}
+
+void earClip(std::span<const glm::vec3> points, std::vector<std::array<unsigned, 3>>& out) {
+    out.clear();
+    if (points.size() < 3) return;
+
+    std::vector<glm::vec2> flat = project(points);
+    std::vector<unsigned> remaining(points.size());
+    for (unsigned i = 0; i < remaining.size(); ++i) remaining[i] = i;
+
+    while (remaining.size() > 3) {
+        const size_t n = remaining.size();
+        bool clipped = false;
+
+        for (size_t i = 0; i < n; ++i) {
+            unsigned prev = remaining[(i + n - 1) % n];
+            unsigned cur = remaining[i];
+            unsigned next = remaining[(i + 1) % n];
+
+            // Vértice reflexo ou degenerado não é orelha
+            if (cross(flat[prev], flat[cur], flat[next]) <= 0) continue;
+
+            bool ear = true;
+            for (unsigned other : remaining) {
+                if (other == prev || other == cur || other == next) continue;
+                if (insideTriangle(flat[other], flat[prev], flat[cur], flat[next])) {
+                    ear = false;
+                    break;
+                }
+            }
+
+            if (ear) {
+                out.push_back({prev, cur, next});
+                remaining.erase(remaining.begin() + i);
+                clipped = true;
+                break;
+            }
+        }
+
+        // Polígono degenerado ou auto-intersectante: fecha em leque
+        if (!clipped) {
+            for (size_t i = 1; i + 1 < remaining.size(); ++i) {
+                out.push_back({remaining[0], remaining[i], remaining[i + 1]});
+            }
+            return;
+        }
+    }
+
+    out.push_back({remaining[0], remaining[1], remaining[2]});
+}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace objloader {
+
+// Verdadeiro se o polígono, projetado no plano de maior área, é convexo. Para
+// esses o leque (0, i, i + 1) já é uma triangulação correta.
+bool isConvex(std::span<const glm::vec3> points);
+
+// Triangulação por corte de orelhas no plano de maior projeção. Escreve
+// points.size() - 2 triângulos com índices locais em out. Polígonos degenerados
+// terminam em leque.
+void earClip(std::span<const glm::vec3> points, std::vector<std::array<unsigned, 3>>& out);
+
+}
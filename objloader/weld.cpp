@@ -0,0 +1,164 @@
+#include "weld.hpp"
+#include "profile.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+
+namespace objloader {
+
+namespace {
+
+struct Cell {
+    int64_t x, y, z;
+
+    bool operator==(const Cell&) const = default;
+};
+
+// Endereçamento aberto de célula -> primeiro representante da lista encadeada.
+// Dimensionada para o pior caso (um representante por vértice), nunca cresce.
+class CellMap {
+    struct Slot {
+        Cell cell;
+        unsigned head;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask;
+
+public:
+    static constexpr unsigned none = UINT_MAX;
+
+    explicit CellMap(size_t expected) {
+        const size_t capacity = std::bit_ceil(std::max<size_t>(16, expected * 2));
+        slots.assign(capacity, Slot{{}, none});
+        mask = capacity - 1;
+    }
+
+    unsigned find(const Cell& cell) const {
+        for (size_t i = hash(cell) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.head == none || slot.cell == cell) return slot.head;
+        }
+    }
+
+    // Cabeça da lista da célula, criada vazia se preciso
+    unsigned& head(const Cell& cell) {
+        for (size_t i = hash(cell) & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.head == none) slot.cell = cell;
+            if (slot.cell == cell) return slot.head;
+        }
+    }
+
+private:
+    static size_t hash(const Cell& c) {
+        uint64_t h = uint64_t(c.x) * 0x9e3779b97f4a7c15ull;
+        h ^= uint64_t(c.y) * 0xc2b2ae3d27d4eb4full;
+        h ^= uint64_t(c.z) * 0x165667b19e3779f9ull;
+        return size_t(h ^ (h >> 29));
+    }
+};
+
+}
+
+bool weldVertices(const IndexedMesh& mesh, float epsilon, MeshBuffers& out) {
+    profile::ScopedTimer timer(profile::Phase::Weld);
+
+    if (!std::isfinite(epsilon) || epsilon <= 0.0f) return false;
+
+    float largest = 0.0f;
+    for (const glm::vec3& p : mesh.vertices) {
+        for (int k = 0; k < 3; ++k) {
+            if (!std::isfinite(p[k])) return false;
+            largest = std::max(largest, std::abs(p[k]));
+        }
+    }
+
+    // Em double, 1 / epsilon é finito até para subnormais
+    const double inverse = 1.0 / epsilon;
+    if (largest * inverse > 0x1p62) return false;
+
+    const bool withNormals = !mesh.normals.empty() && mesh.normals.size() == mesh.vertices.size();
+    const float limit = epsilon * epsilon;
+
+    CellMap cells(mesh.vertices.size());
+    std::vector<unsigned> next;      // próximo representante na mesma célula
+    std::vector<unsigned> remap(mesh.vertices.size());
+
+    out.vertices.clear();
+    out.normals.clear();
+    out.triangles.clear();
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const glm::vec3 p = mesh.vertices[i];
+        const Cell cell{(int64_t)std::floor(p.x * inverse), (int64_t)std::floor(p.y * inverse),
+                        (int64_t)std::floor(p.z * inverse)};
+
+        // Representante mais próximo dentro de epsilon
+        unsigned match = CellMap::none;
+        float best = limit;
+        for (int64_t dx = -1; dx <= 1; ++dx) {
+            for (int64_t dy = -1; dy <= 1; ++dy) {
+                for (int64_t dz = -1; dz <= 1; ++dz) {
+                    for (unsigned r = cells.find({cell.x + dx, cell.y + dy, cell.z + dz}); r != CellMap::none; r = next[r]) {
+                        glm::vec3 d = out.vertices[r] - p;
+                        float dist = glm::dot(d, d);
+                        if (dist <= best) {
+                            best = dist;
+                            match = r;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (match == CellMap::none) {
+            match = (unsigned)out.vertices.size();
+            unsigned& head = cells.head(cell);
+            next.push_back(head);
+            head = match;
+
+            out.vertices.push_back(p);
+            if (withNormals) out.normals.push_back(glm::vec3(0.0f));
+        }
+
+        if (withNormals) out.normals[match] += mesh.normals[i];
+        remap[i] = match;
+    }
+
+    for (auto& n : out.normals) {
+        float length = glm::length(n);
+        if (length > 0.0f) n /= length;
+    }
+
+    out.triangles.reserve(mesh.triangles.size());
+    for (const auto& tri : mesh.triangles) {
+        std::array<unsigned, 3> welded = {remap[tri[0]], remap[tri[1]], remap[tri[2]]};
+        if (welded[0] == welded[1] || welded[1] == welded[2] || welded[0] == welded[2]) continue;
+        out.triangles.push_back(welded);
+    }
+    return true;
+}
+
+void smoothNormals(MeshBuffers& mesh) {
+    mesh.normals.assign(mesh.vertices.size(), glm::vec3(0.0f));
+
+    // O produto vetorial já tem módulo proporcional à área
+    for (const auto& tri : mesh.triangles) {
+        const glm::vec3& v0 = mesh.vertices[tri[0]];
+        glm::vec3 normal = glm::cross(mesh.vertices[tri[1]] - v0, mesh.vertices[tri[2]] - v0);
+        mesh.normals[tri[0]] += normal;
+        mesh.normals[tri[1]] += normal;
+        mesh.normals[tri[2]] += normal;
+    }
+
+    for (auto& n : mesh.normals) {
+        float length = glm::length(n);
+        if (length > 0.0f) n /= length;
+    }
+}
+
+}
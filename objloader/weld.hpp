@@ -0,0 +1,20 @@
+#pragma once
+
+#include "objloader.hpp"
+
+namespace objloader {
+
+// Funde os vértices cujas posições distam no máximo epsilon (> 0), usando um
+// hash espacial de células com lado epsilon: cada vértice só é comparado com
+// os representantes das 27 células vizinhas. O vértice fundido fica com a
+// posição do primeiro representante e, se houver normais, com a média delas.
+// Triângulos que degeneram são descartados. Falso, sem mexer em out, se
+// epsilon não é finito e positivo, se alguma posição não é finita ou se
+// coordenada / epsilon passa de 2^62 (a célula não caberia em int64_t).
+bool weldVertices(const IndexedMesh& mesh, float epsilon, MeshBuffers& out);
+
+// Recalcula mesh.normals como a média das normais das faces vizinhas,
+// ponderada pela área.
+void smoothNormals(MeshBuffers& mesh);
+
+}
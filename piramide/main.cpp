@@ -9,13 +9,21 @@
 
 #include <iostream>
 #include <vector>
+#include <charconv>
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "mesh_cache.hpp"
+#include "profile.hpp"
+#include "weld.hpp"
+
 float lastX = 400.0f, lastY = 400.0f; // posição inicial do cursor (meio da tela)
 float yaw = -90.0f;   // Ângulo horizontal
 float pitch = 0.0f;   // Ângulo vertical
@@ -24,44 +32,27 @@ bool rotating = false;
 // Camera position
 glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 22.0f);
 
-std::vector<glm::vec3> vertices;
-std::vector<glm::vec3> normals;
+// Vértices compartilhados entre faces, com normais suavizadas
+objloader::MeshBuffers mesh;
 
-bool loadOBJ(const std::string& path) {
-    FILE* file = std::fopen(path.c_str(), "r");
-    if (!file) {
-        std::cerr << "Erro ao abrir arquivo: " << path << std::endl;
+bool loadOBJ(const std::string& path, float epsilon) {
+    objloader::IndexedMesh indexed;
+    if (!objloader::loadCached(path, indexed, {.attributes = objloader::Positions})) {
         return false;
     }
 
-    std::vector<glm::vec3> temp_positions;
-    char line[128];
-
-    while (fgets(line, sizeof(line), file)) {
-        if (line[0] == 'v' && line[1] == ' ') {
-            glm::vec3 pos;
-            sscanf(line, "v %f %f %f", &pos.x, &pos.y, &pos.z);
-            temp_positions.push_back(pos);
-        } else if (line[0] == 'f') {
-            int vi[3];
-            sscanf(line, "f %d %d %d", &vi[0], &vi[1], &vi[2]);
-
-            glm::vec3 v0 = temp_positions[vi[0] - 1];
-            glm::vec3 v1 = temp_positions[vi[1] - 1];
-            glm::vec3 v2 = temp_positions[vi[2] - 1];
-
-            vertices.push_back(v0);
-            vertices.push_back(v1);
-            vertices.push_back(v2);
-
-            glm::vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
-            normals.push_back(normal);
-            normals.push_back(normal);
-            normals.push_back(normal);
+    if (epsilon > 0.0f) {
+        if (!objloader::weldVertices(indexed, epsilon, mesh)) {
+            std::cerr << "Epsilon " << epsilon << " pequeno demais para as coordenadas do modelo" << std::endl;
+            return false;
         }
     }
+    else {
+        mesh.vertices.assign(indexed.vertices.begin(), indexed.vertices.end());
+        mesh.triangles.assign(indexed.triangles.begin(), indexed.triangles.end());
+    }
 
-    fclose(file);
+    objloader::smoothNormals(mesh);
     return true;
 }
 
@@ -111,8 +102,21 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
 }
 
 int main(int argc, char** argv) {
-    if (argc < 2 || !loadOBJ(argv[1])) {
-        std::cerr << "Uso: ./viewer arquivo.obj" << std::endl;
+    argc = objloader::profile::init(argc, argv);
+
+    // argv[2] opcional: distância máxima para fundir vértices
+    float epsilon = 0.0f;
+    if (argc > 2) {
+        const char* end = argv[2] + std::strlen(argv[2]);
+        auto [ptr, ec] = std::from_chars(argv[2], end, epsilon);
+        if (ec != std::errc() || ptr != end || !std::isfinite(epsilon) || epsilon < 0.0f) {
+            std::cerr << "Epsilon inválido: " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+
+    if (argc < 2 || !loadOBJ(argv[1], epsilon)) {
+        std::cerr << "Uso: ./viewer arquivo.obj [epsilon]" << std::endl;
         return 1;
     }
 
@@ -171,12 +175,18 @@ int main(int argc, char** argv) {
     // First VBO - vertex positions
     glGenBuffers(1, &vbo[0]);
     glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size()*3*sizeof(float), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size()*3*sizeof(float), &mesh.vertices[0], GL_STATIC_DRAW);
 
     // Second VBO - vertex normals
     glGenBuffers(1, &vbo[1]);
     glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-    glBufferData(GL_ARRAY_BUFFER, normals.size()*3*sizeof(float), &normals[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, mesh.normals.size()*3*sizeof(float), &mesh.normals[0], GL_STATIC_DRAW);
+
+    // EBO - 3 indices per triangle, shared vertices
+    GLuint ebo;
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.triangles.size()*3*sizeof(unsigned), mesh.triangles.data(), GL_STATIC_DRAW);
 
     glEnableVertexAttribArray(0); // Enable vertex attribute at index 0 (positions)
 
@@ -394,10 +404,10 @@ int main(int argc, char** argv) {
 
         /* MODEL MATRIX SETUP */
         // Rotate model around its base
-        auto To = glm::translate(glm::mat4(1.f), -vertices[0]);
+        auto To = glm::translate(glm::mat4(1.f), -mesh.vertices[0]);
         auto S = glm::scale(glm::mat4(1.f), glm::vec3(45.0f, 45.0f, 45.0f));
         auto R = glm::rotate(glm::mat4(1.f), glm::radians(modelAngle), glm::vec3(0.f,1.f,0.f));
-        auto Tb = glm::translate(glm::mat4(1.f), vertices[0]);
+        auto Tb = glm::translate(glm::mat4(1.f), mesh.vertices[0]);
 
         modelMat = Tb*S*R*To;
 
@@ -443,7 +453,7 @@ int main(int argc, char** argv) {
         glEnableVertexAttribArray(1);
 
         /* DRAW THE PYRAMID */
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+        glDrawElements(GL_TRIANGLES, mesh.triangles.size()*3, GL_UNSIGNED_INT, nullptr);
 
         /* SWAP BUFFERS AND POLL EVENTS */
         glfwSwapBuffers(window);
@@ -1,11 +1,51 @@
+#ifndef PROVA03_AABB_CPP
+#define PROVA03_AABB_CPP
+
 #include <vector>
 #include <array>
 #include <memory>
 #include <algorithm>
+#include <atomic>
 #include <limits>
+#include <mutex>
+#include <span>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "thread_pool.hpp"
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+// Acerto mais próximo de um raio: parâmetro t e índice em Mesh::triangles
+struct RayHit {
+    float t{std::numeric_limits<float>::max()};
+    unsigned triangle{0};
+};
+
+// Möller–Trumbore, sem descartar faces de costas. Só aceita 0 < t < t_max.
+inline bool intersectTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float t_max, float& t) {
+    glm::vec3 edge1 = v1 - v0;
+    glm::vec3 edge2 = v2 - v0;
+    glm::vec3 p = glm::cross(ray.direction, edge2);
+    float det = glm::dot(edge1, p);
+    if (std::abs(det) < 1e-12f) return false;
+
+    float inv_det = 1.0f / det;
+    glm::vec3 s = ray.origin - v0;
+    float u = glm::dot(s, p) * inv_det;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = glm::dot(ray.direction, q) * inv_det;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    t = glm::dot(edge2, q) * inv_det;
+    return t > 0.0f && t < t_max;
+}
+
 struct AABB {
     glm::vec3 min_corner;
     glm::vec3 max_corner;
@@ -19,30 +59,21 @@ struct AABB {
         return min_corner.x > max_corner.x || min_corner.y > max_corner.y || min_corner.z > max_corner.z;
     }
     
+    // Caixa que envolve a caixa transformada por uma matriz afim: centro
+    // transformado e meia-extensão pelos valores absolutos da parte linear
+    // (Arvo), o mesmo resultado dos 8 cantos com duas multiplicações.
     AABB transform(const glm::mat4& matrix) const {
         if (isEmpty()) return *this;
-        
-        glm::vec3 corners[8] = {
-            {min_corner.x, min_corner.y, min_corner.z},
-            {min_corner.x, min_corner.y, max_corner.z},
-            {min_corner.x, max_corner.y, min_corner.z},
-            {min_corner.x, max_corner.y, max_corner.z},
-            {max_corner.x, min_corner.y, min_corner.z},
-            {max_corner.x, min_corner.y, max_corner.z},
-            {max_corner.x, max_corner.y, min_corner.z},
-            {max_corner.x, max_corner.y, max_corner.z}
-        };
 
-        glm::vec3 new_min(std::numeric_limits<float>::max());
-        glm::vec3 new_max(std::numeric_limits<float>::lowest());
+        glm::vec3 center = (min_corner + max_corner) * 0.5f;
+        glm::vec3 extent = (max_corner - min_corner) * 0.5f;
 
-        for (const auto& corner : corners) {
-            glm::vec3 transformed = glm::vec3(matrix * glm::vec4(corner, 1.0f));
-            new_min = glm::min(new_min, transformed);
-            new_max = glm::max(new_max, transformed);
-        }
+        glm::vec3 new_center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+        glm::mat3 linear(matrix);
+        glm::mat3 absolute(glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2]));
+        glm::vec3 new_extent = absolute * extent;
 
-        return AABB(new_min, new_max);
+        return AABB(new_center - new_extent, new_center + new_extent);
     }
     
     bool intersects(const AABB& other) const {
@@ -51,6 +82,40 @@ struct AABB {
                (min_corner.z <= other.max_corner.z && max_corner.z >= other.min_corner.z);
     }
     
+    // Teste de placas; inv_direction = 1 / ray.direction. t_near recebe a
+    // entrada na caixa (negativa se a origem está dentro).
+    bool intersects(const Ray& ray, const glm::vec3& inv_direction, float t_max, float& t_near) const {
+        glm::vec3 t0 = (min_corner - ray.origin) * inv_direction;
+        glm::vec3 t1 = (max_corner - ray.origin) * inv_direction;
+        glm::vec3 t_min = glm::min(t0, t1);
+        glm::vec3 t_max3 = glm::max(t0, t1);
+
+        t_near = std::max({t_min.x, t_min.y, t_min.z});
+        float t_far = std::min({t_max3.x, t_max3.y, t_max3.z});
+        return t_near <= t_far && t_far >= 0.0f && t_near <= t_max;
+    }
+    
+    bool contains(const AABB& other) const {
+        return glm::all(glm::lessThanEqual(min_corner, other.min_corner)) &&
+               glm::all(glm::greaterThanEqual(max_corner, other.max_corner));
+    }
+
+    void expand(const glm::vec3& point) {
+        min_corner = glm::min(min_corner, point);
+        max_corner = glm::max(max_corner, point);
+    }
+
+    void expand(const AABB& other) {
+        min_corner = glm::min(min_corner, other.min_corner);
+        max_corner = glm::max(max_corner, other.max_corner);
+    }
+
+    float surfaceArea() const {
+        if (isEmpty()) return 0.0f;
+        glm::vec3 size = max_corner - min_corner;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+    
     unsigned short getLargestAxis() const {
         glm::vec3 size = max_corner - min_corner;
 
@@ -73,11 +138,21 @@ struct Mesh {
     AABB aabb;
     std::shared_ptr<const coordinate_t> coordinates;
     triangles_t triangles;
+    // Muda a cada troca ou edição das coordenadas (touch()), com valores
+    // únicos no processo: quem guarda dados derivados delas compara a versão
+    uint64_t version{nextVersion()};
     
-    Mesh(std::shared_ptr<const coordinate_t> coords, const triangles_t& tris) : 
-        coordinates(std::move(coords)), triangles(tris) {
+    Mesh(std::shared_ptr<const coordinate_t> coords, triangles_t tris) : 
+        coordinates(std::move(coords)), triangles(std::move(tris)) {
         updateAABB();
     }
+
+    static uint64_t nextVersion() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    void touch() { version = nextVersion(); }
     
     void updateAABB() {
         if (triangles.empty()) {
@@ -98,118 +173,489 @@ struct Mesh {
 
         aabb = AABB(min, max);
     }
-    
-    void sortTrianglesByAxis(unsigned axis) {
-        auto comparator = [&](const std::array<unsigned, 3>& a, const std::array<unsigned, 3>& b) {
-            glm::vec3 centroid_a = ((*coordinates)[a[0]] + (*coordinates)[a[1]] + (*coordinates)[a[2]]) / 3.0f;
-            glm::vec3 centroid_b = ((*coordinates)[b[0]] + (*coordinates)[b[1]] + (*coordinates)[b[2]]) / 3.0f;
-            return centroid_a[axis] < centroid_b[axis];
-        };
-        std::sort(triangles.begin(), triangles.end(), comparator);
-    }
-    
-    std::pair<Mesh, Mesh> splitMesh() const {
-        if (triangles.empty()) 
-            return {Mesh(coordinates, {}), Mesh(coordinates, {})};
-
-        unsigned axis = aabb.getLargestAxis();
-        std::vector<float> centroids;
-        centroids.reserve(triangles.size());
-        
-        for (const auto& tri : triangles) {
-            glm::vec3 centroid = ((*coordinates)[tri[0]] + (*coordinates)[tri[1]] + (*coordinates)[tri[2]]) / 3.0f;
-            centroids.push_back(centroid[axis]);
-        }
-
-        size_t mid = centroids.size() / 2;
-        std::nth_element(centroids.begin(), centroids.begin() + mid, centroids.end());
-        float median = centroids[mid];
-
-        triangles_t first, second;
-        for (const auto& tri : triangles) {
-            glm::vec3 centroid = ((*coordinates)[tri[0]] + (*coordinates)[tri[1]] + (*coordinates)[tri[2]]) / 3.0f;
-            (centroid[axis] <= median ? first : second).push_back(tri);
-        }
-
-        if (first.empty() || second.empty()) {
-            size_t half = triangles.size() / 2;
-            first.assign(triangles.begin(), triangles.begin() + half);
-            second.assign(triangles.begin() + half, triangles.end());
-        }
 
-        return {Mesh(coordinates, first), Mesh(coordinates, second)};
+    glm::vec3 centroid(unsigned triangle) const {
+        const auto& tri = triangles[triangle];
+        return ((*coordinates)[tri[0]] + (*coordinates)[tri[1]] + (*coordinates)[tri[2]]) / 3.0f;
     }
 };
 
+// Median: mediana dos centróides no maior eixo. BinnedSAH: melhor corte entre
+// 16 faixas de centróides por eixo segundo a heurística de área de superfície,
+// que também decide quando vale mais parar numa folha.
+enum class SplitStrategy {
+    Median,
+    BinnedSAH
+};
+
+// Nó do BVH linearizado em profundidade: o filho esquerdo é sempre o nó
+// seguinte e right guarda o índice do direito (0 nas folhas, já que a raiz
+// nunca é filha). Cada nó cobre triangle_indices[offset, offset + count).
+// As caixas ficam no espaço do modelo; consultas levam uma árvore para o
+// espaço da outra em vez de transformar todos os nós.
 struct AABBNode {
-    Mesh mesh;
     AABB original_aabb;
-    AABB transformed_aabb;
-    bool leaf{false};
-    std::unique_ptr<AABBNode> left_child;
-    std::unique_ptr<AABBNode> right_child;
+    unsigned right{0};
+    unsigned offset{0};
+    unsigned count{0};
     
-    AABBNode(const Mesh& m) : mesh(m), original_aabb(m.aabb), transformed_aabb(m.aabb) {}
-    
-    bool isLeaf() const { return leaf; }
-    void makeLeaf() { leaf = true; }
+    bool isLeaf() const { return right == 0; }
 };
 
 class AABBTree {
-    std::unique_ptr<AABBNode> root;
-    glm::mat4 last_transform{1.0f};
-    bool force_update{true};
+    Mesh mesh;
+    std::vector<AABBNode> nodes;
+    std::vector<unsigned> triangle_indices;
+    // Árvore lida de um arquivo (attach): as consultas usam estas vistas e os
+    // vetores acima ficam vazios até um build() ou refit()
+    std::shared_ptr<const void> mapped;
+    std::span<const AABBNode> mapped_nodes;
+    std::span<const unsigned> mapped_indices;
     unsigned max_depth{16};
     unsigned min_triangles{4};
+    SplitStrategy strategy;
+    float build_cost{0.0f};
+
+    static constexpr unsigned sah_bins = 16;
+    static constexpr unsigned sah_max_leaf = 16;
+    // Faixas com ao menos isso de triângulos viram tarefas no pool
+    static constexpr unsigned parallel_cutoff = 1u << 14;
+
+    struct BuildContext {
+        std::vector<glm::vec3> centroids;
+        objloader::ThreadPool* pool;
+    };
     
 public:
-    AABBTree(const Mesh& mesh) {
-        root = std::make_unique<AABBNode>(mesh);
-    }
+    using Volume = AABB;
+    static constexpr unsigned root = 0;
+    // Níveis abaixo da raiz aceitos numa árvore vinda de fora (attach); o
+    // build para em max_depth + 1. As travessias dimensionam pilhas por isso.
+    static constexpr unsigned depth_limit = 32;
+
+    AABBTree(Mesh m, SplitStrategy split = SplitStrategy::Median) : mesh(std::move(m)), strategy(split) {}
     
-    void build() {
-        build(root, 0);
+    // Com pool, subárvores grandes são construídas em paralelo; o resultado é
+    // idêntico ao da construção serial (pool == nullptr).
+    void build(objloader::ThreadPool* pool = &objloader::ThreadPool::shared()) {
+        const unsigned count = (unsigned)mesh.triangles.size();
+        if (pool && (pool->size() < 2 || count < parallel_cutoff)) pool = nullptr;
+
+        detach();
+
+        BuildContext context{std::vector<glm::vec3>(count), pool};
+        triangle_indices.resize(count);
+
+        forChunks(0, count, pool, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) {
+                triangle_indices[i] = i;
+                context.centroids[i] = mesh.centroid(i);
+            }
+        });
+
+        nodes.clear();
+        nodes.reserve(2 * (count / min_triangles) + 1);
+        build(nodes, 0, count, 0, context);
+        nodes.shrink_to_fit();
+        build_cost = sahCost();
     }
-    
-    void updateTransform(const glm::mat4& transform) {
-        if (transform == last_transform && !force_update) return;
-        last_transform = transform;
-        force_update = false;
-        updateNodeTransform(root.get(), transform);
+
+    // Para malhas que se deformam: recalcula as caixas a partir das coordenadas
+    // atuais sem mudar a topologia, numa passada linear de trás para frente (os
+    // filhos vêm sempre depois do pai). Retorna costRatio(). Também marca as
+    // coordenadas como mudadas (Mesh::touch), inclusive se editadas no lugar.
+    float refit() {
+        mesh.touch();
+        if (mapped) {
+            nodes.assign(mapped_nodes.begin(), mapped_nodes.end());
+            triangle_indices.assign(mapped_indices.begin(), mapped_indices.end());
+            detach();
+        }
+
+        for (size_t i = nodes.size(); i-- > 0;) {
+            AABBNode& node = nodes[i];
+            AABB box;
+
+            if (node.isLeaf()) {
+                for (unsigned t : triangles(node)) {
+                    for (auto idx : mesh.triangles[t]) {
+                        box.expand((*mesh.coordinates)[idx]);
+                    }
+                }
+            }
+            else {
+                box = nodes[i + 1].original_aabb;
+                box.expand(nodes[node.right].original_aabb);
+            }
+
+            node.original_aabb = box;
+        }
+
+        mesh.aabb = nodes.empty() ? AABB() : nodes[root].original_aabb;
+        return costRatio();
+    }
+
+    // Troca as coordenadas (mesmos triângulos) e ajusta as caixas.
+    float refit(std::shared_ptr<const Mesh::coordinate_t> coords) {
+        mesh.coordinates = std::move(coords);
+        return refit();
+    }
+
+    // Custo SAH da árvore: soma das áreas dos nós internos (uma travessia) e
+    // das folhas vezes seus triângulos, relativa à área da raiz.
+    float sahCost() const {
+        if (empty()) return 0.0f;
+
+        float root_area = volume(root).surfaceArea();
+        if (root_area <= 0.0f) return 0.0f;
+
+        double total = 0.0;
+        for (const auto& node : allNodes()) {
+            total += double(node.original_aabb.surfaceArea()) * (node.isLeaf() ? node.count : 1);
+        }
+        return float(total / root_area);
+    }
+
+    // sahCost() atual sobre o do último build: 1 logo após build(), cresce
+    // conforme refits afrouxam as caixas. Acima de ~1.5 costuma compensar
+    // reconstruir.
+    float costRatio() const {
+        return build_cost > 0.0f ? sahCost() / build_cost : 1.0f;
     }
     
-    void forceUpdate() { 
-        force_update = true; 
+    // Passa a consultar nós e permutação guardados em outro lugar (um arquivo
+    // mapeado, mantido vivo por storage), sem copiar. Falso se não batem com a
+    // malha ou não formam uma árvore válida (ver validLayout).
+    bool attach(std::span<const AABBNode> tree_nodes, std::span<const unsigned> indices, std::shared_ptr<const void> storage) {
+        if (!storage || indices.size() != mesh.triangles.size() || tree_nodes.empty() != indices.empty()) return false;
+        if (!validLayout(tree_nodes, indices)) return false;
+
+        nodes = {};
+        triangle_indices = {};
+        mapped = std::move(storage);
+        mapped_nodes = tree_nodes;
+        mapped_indices = indices;
+        mesh.aabb = tree_nodes.empty() ? AABB() : tree_nodes[root].original_aabb;
+        build_cost = sahCost();
+        return true;
+    }
+
+    bool isMapped() const { return mapped != nullptr; }
+    SplitStrategy splitStrategy() const { return strategy; }
+
+    bool empty() const { return allNodes().empty(); }
+    size_t nodeCount() const { return allNodes().size(); }
+
+    // Nós e permutação dos triângulos, sem a malha; uma árvore mapeada não
+    // ocupa heap
+    size_t memoryBytes() const {
+        return nodes.capacity() * sizeof(AABBNode) + triangle_indices.capacity() * sizeof(unsigned);
     }
 
-    AABBNode* getRoot() const { return root.get(); }
+    const AABBNode& node(unsigned index) const { return allNodes()[index]; }
+    const AABB& volume(unsigned index) const { return allNodes()[index].original_aabb; }
+    unsigned leftChild(unsigned index) const { return index + 1; }
+    unsigned rightChild(unsigned index) const { return allNodes()[index].right; }
+
+    // Todos os nós em profundidade e a permutação inteira, para gravar a árvore
+    std::span<const AABBNode> allNodes() const { return mapped ? mapped_nodes : std::span<const AABBNode>(nodes); }
+    std::span<const unsigned> allTriangles() const { return mapped ? mapped_indices : std::span<const unsigned>(triangle_indices); }
+
+    const Mesh& getMesh() const { return mesh; }
+    const Mesh::coordinate_t& coordinates() const { return *mesh.coordinates; }
+
+    // Índices em getMesh().triangles dos triângulos sob o nó
+    std::span<const unsigned> triangles(const AABBNode& node) const {
+        return allTriangles().subspan(node.offset, node.count);
+    }
+
+    const std::array<unsigned, 3>& triangle(unsigned index) const { return mesh.triangles[index]; }
+
+    // Acerto mais próximo com t < hit.t, em profundidade com pilha explícita,
+    // visitando antes o filho que o raio atinge primeiro.
+    bool raycast(const Ray& ray, RayHit& hit) const {
+        if (empty()) return false;
+
+        const std::span<const AABBNode> tree_nodes = allNodes();
+        const glm::vec3 inv_direction = 1.0f / ray.direction;
+        const auto& coords = *mesh.coordinates;
+        bool found = false;
+
+        float t_near;
+        if (!tree_nodes[root].original_aabb.intersects(ray, inv_direction, hit.t, t_near)) return false;
+
+        unsigned stack[64];
+        unsigned size = 0;
+        stack[size++] = root;
+
+        while (size > 0) {
+            const unsigned index = stack[--size];
+            const AABBNode& node = tree_nodes[index];
+
+            if (node.isLeaf()) {
+                for (unsigned t : triangles(node)) {
+                    const auto& tri = mesh.triangles[t];
+                    float distance;
+                    if (intersectTriangle(ray, coords[tri[0]], coords[tri[1]], coords[tri[2]], hit.t, distance)) {
+                        hit = {distance, t};
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            unsigned left = leftChild(index);
+            unsigned right = node.right;
+            float t_left, t_right;
+            bool hit_left = tree_nodes[left].original_aabb.intersects(ray, inv_direction, hit.t, t_left);
+            bool hit_right = tree_nodes[right].original_aabb.intersects(ray, inv_direction, hit.t, t_right);
+
+            // O mais próximo por último, para sair primeiro da pilha
+            if (hit_left && hit_right && t_left < t_right) {
+                stack[size++] = right;
+                stack[size++] = left;
+            }
+            else {
+                if (hit_left) stack[size++] = left;
+                if (hit_right) stack[size++] = right;
+            }
+        }
+
+        return found;
+    }
 
-        
 private:
-    void build(std::unique_ptr<AABBNode>& node, unsigned depth) {
-        if (!node || node->isLeaf()) return;
+    // Nós em profundidade como o build grava: cada nó interno tem o esquerdo
+    // logo depois e o direito dentro da própria faixa, as subárvores cobrem
+    // todos os nós sem sobra, nenhuma folha passa de depth_limit níveis, as
+    // faixas das folhas cabem na permutação e ela só aponta para triângulos
+    // que existem.
+    static bool validLayout(std::span<const AABBNode> tree_nodes, std::span<const unsigned> indices) {
+        for (unsigned t : indices) {
+            if (t >= indices.size()) return false;
+        }
+        if (tree_nodes.empty()) return true;
 
-        if (depth > max_depth || node->mesh.triangles.size() <= min_triangles) {
-            node->makeLeaf();
+        // Nó, fim da faixa da subárvore dele e nível
+        struct Entry { size_t index, end; unsigned depth; };
+        Entry stack[depth_limit + 2];
+        unsigned size = 0;
+        stack[size++] = {root, tree_nodes.size(), 0};
+
+        while (size > 0) {
+            const Entry entry = stack[--size];
+            if (entry.depth > depth_limit) return false;
+
+            const AABBNode& node = tree_nodes[entry.index];
+            if (node.isLeaf()) {
+                if (entry.end != entry.index + 1 || (size_t)node.offset + node.count > indices.size()) return false;
+                continue;
+            }
+
+            if (node.right <= entry.index + 1 || node.right >= entry.end) return false;
+            stack[size++] = {node.right, entry.end, entry.depth + 1};
+            stack[size++] = {entry.index + 1, node.right, entry.depth + 1};
+        }
+        return true;
+    }
+
+    void detach() {
+        mapped.reset();
+        mapped_nodes = {};
+        mapped_indices = {};
+    }
+
+    // fn(b, e) sobre blocos de [begin, end), no pool se houver
+    template <typename F>
+    static void forChunks(unsigned begin, unsigned end, objloader::ThreadPool* pool, F&& fn) {
+        if (!pool || end - begin < parallel_cutoff) {
+            fn(begin, end);
             return;
         }
 
-        auto sub_meshes = node->mesh.splitMesh();
-        node->left_child = std::make_unique<AABBNode>(sub_meshes.first);
-        node->right_child = std::make_unique<AABBNode>(sub_meshes.second);
+        const unsigned chunks = pool->size() * 4;
+        const unsigned step = (end - begin + chunks - 1) / chunks;
+        pool->parallelFor(chunks, [&](size_t k) {
+            unsigned first = begin + std::min(end - begin, unsigned(k) * step);
+            unsigned last = begin + std::min(end - begin, unsigned(k + 1) * step);
+            if (first < last) fn(first, last);
+        });
+    }
 
-        build(node->left_child, depth + 1);
-        build(node->right_child, depth + 1);
+    AABB bounds(unsigned begin, unsigned end, objloader::ThreadPool* pool) const {
+        // min/max são exatos: juntar os blocos dá a mesma caixa da passada serial
+        std::mutex mutex;
+        AABB box;
+        forChunks(begin, end, pool, [&](unsigned first, unsigned last) {
+            AABB partial;
+            for (unsigned i = first; i < last; ++i) {
+                for (auto idx : mesh.triangles[triangle_indices[i]]) {
+                    partial.expand((*mesh.coordinates)[idx]);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            box.expand(partial);
+        });
+
+        return box;
     }
-    
-    void updateNodeTransform(AABBNode* node, const glm::mat4& transform) {
-        if (!node) return;
-        
-        node->transformed_aabb = node->original_aabb.transform(transform);
-        
-        if (!node->isLeaf()) {
-            updateNodeTransform(node->left_child.get(), transform);
-            updateNodeTransform(node->right_child.get(), transform);
+
+    AABB triangleBounds(unsigned triangle) const {
+        const auto& tri = mesh.triangles[triangle];
+        AABB box;
+        for (auto idx : tri) {
+            box.expand((*mesh.coordinates)[idx]);
         }
+        return box;
     }
-};
\ No newline at end of file
+
+    unsigned splitMedian(unsigned begin, unsigned end, const AABB& box, const std::vector<glm::vec3>& centroids) {
+        unsigned axis = box.getLargestAxis();
+        std::vector<float> values;
+        values.reserve(end - begin);
+        for (unsigned i = begin; i < end; ++i) {
+            values.push_back(centroids[triangle_indices[i]][axis]);
+        }
+
+        size_t half = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + half, values.end());
+        float median = values[half];
+
+        auto first = triangle_indices.begin() + begin;
+        auto last = triangle_indices.begin() + end;
+        return (unsigned)(std::partition(first, last, [&](unsigned t) {
+            return centroids[t][axis] <= median;
+        }) - triangle_indices.begin());
+    }
+
+    // Corte de menor custo SAH; end quando uma folha custa menos que qualquer
+    // corte, begin quando os centróides coincidem e não há como separar.
+    unsigned splitSAH(unsigned begin, unsigned end, const AABB& box, const std::vector<glm::vec3>& centroids) {
+        struct Bin {
+            AABB box;
+            unsigned count{0};
+        };
+
+        AABB centroid_box;
+        for (unsigned i = begin; i < end; ++i) {
+            centroid_box.expand(centroids[triangle_indices[i]]);
+        }
+
+        float best_cost = std::numeric_limits<float>::max();
+        unsigned best_axis = 0;
+        unsigned best_bin = 0;
+
+        for (unsigned axis = 0; axis < 3; ++axis) {
+            float extent = centroid_box.max_corner[axis] - centroid_box.min_corner[axis];
+            if (extent <= 0.0f) continue;
+
+            float scale = sah_bins / extent;
+            Bin bins[sah_bins];
+            for (unsigned i = begin; i < end; ++i) {
+                unsigned t = triangle_indices[i];
+                unsigned b = std::min(sah_bins - 1, (unsigned)((centroids[t][axis] - centroid_box.min_corner[axis]) * scale));
+                bins[b].count++;
+                bins[b].box.expand(triangleBounds(t));
+            }
+
+            // Área e contagem à direita de cada corte, varrendo de trás para frente
+            float right_area[sah_bins - 1];
+            unsigned right_count[sah_bins - 1];
+            AABB right;
+            unsigned count = 0;
+            for (unsigned b = sah_bins - 1; b > 0; --b) {
+                right.expand(bins[b].box);
+                count += bins[b].count;
+                right_area[b - 1] = right.surfaceArea();
+                right_count[b - 1] = count;
+            }
+
+            AABB left;
+            count = 0;
+            for (unsigned b = 0; b < sah_bins - 1; ++b) {
+                left.expand(bins[b].box);
+                count += bins[b].count;
+                if (count == 0 || right_count[b] == 0) continue;
+
+                float cost = count * left.surfaceArea() + right_count[b] * right_area[b];
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = b;
+                }
+            }
+        }
+
+        if (best_cost == std::numeric_limits<float>::max()) return begin;
+
+        // Custo relativo: 1 travessia + testes ponderados pela área, contra n testes numa folha
+        float area = box.surfaceArea();
+        float split_cost = 1.0f + (area > 0.0f ? best_cost / area : 0.0f);
+        if (split_cost >= float(end - begin) && end - begin <= sah_max_leaf) return end;
+
+        float scale = sah_bins / (centroid_box.max_corner[best_axis] - centroid_box.min_corner[best_axis]);
+        float origin = centroid_box.min_corner[best_axis];
+        auto first = triangle_indices.begin() + begin;
+        auto last = triangle_indices.begin() + end;
+        return (unsigned)(std::partition(first, last, [&](unsigned t) {
+            return std::min(sah_bins - 1, (unsigned)((centroids[t][best_axis] - origin) * scale)) <= best_bin;
+        }) - triangle_indices.begin());
+    }
+
+    // Anexa a out o nó de [begin, end) e, em seguida, as subárvores esquerda e
+    // direita. Acima do corte, a direita é construída numa tarefa em outro
+    // vetor e copiada depois da esquerda com os índices deslocados.
+    unsigned build(std::vector<AABBNode>& out, unsigned begin, unsigned end, unsigned depth, const BuildContext& context) {
+        const unsigned index = (unsigned)out.size();
+        out.emplace_back();
+
+        AABB box = bounds(begin, end, context.pool);
+        out[index].original_aabb = box;
+        out[index].offset = begin;
+        out[index].count = end - begin;
+
+        if (depth > max_depth || end - begin <= min_triangles) {
+            return index;
+        }
+
+        unsigned mid;
+        if (strategy == SplitStrategy::BinnedSAH) {
+            mid = splitSAH(begin, end, box, context.centroids);
+            if (mid == end) return index;
+        }
+        else {
+            mid = splitMedian(begin, end, box, context.centroids);
+        }
+
+        if (mid == begin || mid == end) {
+            mid = begin + (end - begin) / 2;
+        }
+
+        if (!context.pool || end - begin < parallel_cutoff) {
+            build(out, begin, mid, depth + 1, context);
+            unsigned right = build(out, mid, end, depth + 1, context);
+            out[index].right = right;
+            return index;
+        }
+
+        std::vector<AABBNode> right_nodes;
+        auto right_task = context.pool->submit([&] {
+            right_nodes.reserve(2 * ((end - mid) / min_triangles) + 1);
+            build(right_nodes, mid, end, depth + 1, context);
+        });
+
+        build(out, begin, mid, depth + 1, context);
+        context.pool->wait(right_task);
+
+        const unsigned right = (unsigned)out.size();
+        for (AABBNode node : right_nodes) {
+            if (!node.isLeaf()) node.right += right;
+            out.push_back(node);
+        }
+        out[index].right = right;
+        return index;
+    }
+};
+
+#endif
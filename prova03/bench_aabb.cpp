@@ -0,0 +1,188 @@
+// Benchmark das estratégias de construção do AABBTree, do OBBTree, dos BVHs
+// largos e do quantizado: tempo de build, nós, memória da árvore (sem a
+// malha), folhas e testes de caixa/triângulo por consulta
+// de verificaColisao numa varredura em que o segundo modelo gira e atravessa o
+// primeiro; depois, raios lançados de fora contra o primeiro modelo.
+//
+// Uso: bench_aabb <a.obj> [b.obj] [quadros]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "colisao.cpp"
+#include "objloader.hpp"
+
+namespace {
+
+template <typename F>
+double timeMs(F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+Mesh toMesh(const objloader::IndexedMesh& mesh) {
+    auto coords = std::make_shared<Mesh::coordinate_t>(mesh.vertices.begin(), mesh.vertices.end());
+    return Mesh(coords, Mesh::triangles_t(mesh.triangles.begin(), mesh.triangles.end()));
+}
+
+// Escala para caber num cubo unitário ao redor do primeiro vértice, como no prova03
+glm::mat4 normalizar(const objloader::IndexedMesh& mesh) {
+    AABB box;
+    for (const auto& v : mesh.vertices) box.expand(v);
+    glm::vec3 size = box.max_corner - box.min_corner;
+    float scale = 1.0f / std::max({size.x, size.y, size.z});
+    glm::vec3 pivot = mesh.vertices[0];
+    return glm::translate(glm::mat4(1.0f), pivot) * glm::scale(glm::mat4(1.0f), glm::vec3(scale)) *
+           glm::translate(glm::mat4(1.0f), -pivot);
+}
+
+template <typename Tree>
+size_t leafCount(const Tree& tree) {
+    size_t leaves = 0;
+    for (unsigned i = 0; i < tree.nodeCount(); ++i) {
+        if (tree.node(i).isLeaf()) ++leaves;
+    }
+    return leaves;
+}
+
+template <unsigned Width>
+size_t leafCount(const WideBVH<Width>& tree) {
+    size_t leaves = 0;
+    for (unsigned i = 0; i < tree.nodeCount(); ++i) {
+        leaves += std::popcount(tree.node(i).leaves);
+    }
+    return leaves;
+}
+
+// Só os nós internos são guardados: a árvore é binária completa
+size_t leafCount(const QuantizedBVH& tree) {
+    return tree.empty() ? 0 : tree.nodeCount() + 1;
+}
+
+template <typename Tree>
+void run(const char* name, SplitStrategy strategy, const objloader::IndexedMesh& meshA,
+         const objloader::IndexedMesh& meshB, int frames) {
+    Tree treeA(toMesh(meshA), strategy);
+    Tree treeB(toMesh(meshB), strategy);
+
+    double buildMs = timeMs([&] {
+        treeA.build();
+        treeB.build();
+    });
+
+    const size_t leaves = leafCount(treeA);
+
+    const glm::mat4 baseA = normalizar(meshA);
+    const glm::mat4 baseB = normalizar(meshB);
+
+    EstatisticasColisao stats;
+    VerticesMundo mundoA, mundoB;
+    int hits = 0;
+    double queryMs = timeMs([&] {
+        for (int f = 0; f < frames; ++f) {
+            float offset = 0.15f + 0.6f * std::sin(f * 0.01f);
+            glm::mat4 transformB = glm::translate(glm::mat4(1.0f), glm::vec3(offset, 0.0f, 0.0f)) *
+                                   glm::rotate(glm::mat4(1.0f), glm::radians(f * 0.5f), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                                   baseB;
+
+            hits += verificaColisao(treeA, treeB, baseA, transformB, &stats, &mundoA, &mundoB);
+        }
+    });
+
+    std::printf("%-10s %10.2f %10zu %10.1f %8zu %8.1f %12.1f %12.1f %10.4f %6d\n", name, buildMs, treeA.nodeCount(),
+                treeA.memoryBytes() / 1024.0, leaves,
+                double(meshA.triangles.size()) / leaves, double(stats.testesCaixa) / frames,
+                double(stats.testesTriangulo) / frames, queryMs / frames, hits);
+}
+
+// Raios de pontos numa esfera ao redor do modelo para pontos dentro da caixa
+std::vector<Ray> makeRays(const objloader::IndexedMesh& mesh, int count) {
+    AABB box;
+    for (const auto& v : mesh.vertices) box.expand(v);
+    const glm::vec3 center = (box.min_corner + box.max_corner) * 0.5f;
+    const glm::vec3 half = (box.max_corner - box.min_corner) * 0.5f;
+    const float radius = 2.0f * glm::length(half);
+
+    std::mt19937 rng(937);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<Ray> rays(count);
+    for (auto& ray : rays) {
+        glm::vec3 from;
+        do {
+            from = glm::vec3(unit(rng), unit(rng), unit(rng));
+        } while (glm::dot(from, from) > 1.0f || glm::dot(from, from) < 1e-4f);
+
+        ray.origin = center + radius * glm::normalize(from);
+        glm::vec3 target = center + half * glm::vec3(unit(rng), unit(rng), unit(rng));
+        ray.direction = glm::normalize(target - ray.origin);
+    }
+    return rays;
+}
+
+template <typename Tree>
+void runRays(const char* name, SplitStrategy strategy, const objloader::IndexedMesh& mesh, const std::vector<Ray>& rays) {
+    Tree tree(toMesh(mesh), strategy);
+    tree.build();
+
+    int hits = 0;
+    double distance = 0.0;
+    double ms = timeMs([&] {
+        for (const Ray& ray : rays) {
+            RayHit hit;
+            if (tree.raycast(ray, hit)) {
+                ++hits;
+                distance += hit.t;
+            }
+        }
+    });
+
+    std::printf("%-10s %10zu %12.3f %8d %14.6f\n", name, tree.nodeCount(), 1000.0 * ms / rays.size(), hits,
+                hits ? distance / hits : 0.0);
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Uso: %s <a.obj> [b.obj] [quadros]\n", argv[0]);
+        return 1;
+    }
+
+    const objloader::ParseOptions options{.attributes = objloader::Positions};
+    objloader::IndexedMesh meshA, meshB;
+    if (!objloader::loadIndexed(argv[1], meshA, options) ||
+        !objloader::loadIndexed(argc > 2 ? argv[2] : argv[1], meshB, options)) {
+        return 1;
+    }
+
+    int frames = argc > 3 ? std::atoi(argv[3]) : 720;
+
+    std::printf("A: %zu triângulos, B: %zu triângulos, %d quadros\n\n", meshA.triangles.size(),
+                meshB.triangles.size(), frames);
+    std::printf("%-10s %10s %10s %10s %8s %8s %12s %12s %10s %6s\n", "split", "build ms", "nós A", "KB A", "folhas", "tri/folha",
+                "caixas/cons", "tris/cons", "ms/cons", "hits");
+
+    run<AABBTree>("median", SplitStrategy::Median, meshA, meshB, frames);
+    run<AABBTree>("sah", SplitStrategy::BinnedSAH, meshA, meshB, frames);
+    run<OBBTree>("median/obb", SplitStrategy::Median, meshA, meshB, frames);
+    run<OBBTree>("sah/obb", SplitStrategy::BinnedSAH, meshA, meshB, frames);
+    run<WideBVH<4>>("sah/4", SplitStrategy::BinnedSAH, meshA, meshB, frames);
+    run<WideBVH<8>>("sah/8", SplitStrategy::BinnedSAH, meshA, meshB, frames);
+    run<QuantizedBVH>("sah/q16", SplitStrategy::BinnedSAH, meshA, meshB, frames);
+
+    const std::vector<Ray> rays = makeRays(meshA, 100000);
+    std::printf("\n%zu raios contra A\n\n", rays.size());
+    std::printf("%-10s %10s %12s %8s %14s\n", "árvore", "nós", "us/raio", "acertos", "t médio");
+    runRays<AABBTree>("median", SplitStrategy::Median, meshA, rays);
+    runRays<AABBTree>("sah", SplitStrategy::BinnedSAH, meshA, rays);
+    runRays<WideBVH<4>>("sah/4", SplitStrategy::BinnedSAH, meshA, rays);
+    runRays<WideBVH<8>>("sah/8", SplitStrategy::BinnedSAH, meshA, rays);
+    runRays<QuantizedBVH>("sah/q16", SplitStrategy::BinnedSAH, meshA, rays);
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Benchmark da fase ampla: N caixas andando em linha reta dentro de um cubo
+// (refletindo nas paredes). Por quadro, tempo de atualizar a DynamicAABBTree
+// e tirar os pares candidatos contra o teste de todos os pares, folhas
+// reinseridas, altura da árvore e pares.
+//
+// Uso: bench_broad [objetos] [quadros] [margem]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "broad_phase.cpp"
+
+namespace {
+
+template <typename F>
+double timeMs(F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+struct Corpo {
+    glm::vec3 center;
+    glm::vec3 velocity;
+    float radius;
+
+    AABB box() const { return AABB(center - glm::vec3(radius), center + glm::vec3(radius)); }
+};
+
+}
+
+int main(int argc, char** argv) {
+    const unsigned count = argc > 1 ? (unsigned)std::atoi(argv[1]) : 4000;
+    const unsigned frames = argc > 2 ? (unsigned)std::atoi(argv[2]) : 200;
+    const float margin = argc > 3 ? (float)std::atof(argv[3]) : 0.1f;
+
+    // Cubo com densidade constante: uns poucos vizinhos por objeto
+    const float side = 4.0f * std::cbrt((float)count);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(0.0f, side), speed(-0.05f, 0.05f), size(0.3f, 1.0f);
+
+    std::vector<Corpo> corpos(count);
+    for (auto& c : corpos) {
+        c.center = glm::vec3(position(rng), position(rng), position(rng));
+        c.velocity = glm::vec3(speed(rng), speed(rng), speed(rng));
+        c.radius = size(rng);
+    }
+
+    DynamicAABBTree cena(margin);
+    std::vector<unsigned> proxies(count);
+    double insert_ms = timeMs([&] {
+        for (unsigned i = 0; i < count; ++i) proxies[i] = cena.insert(corpos[i].box(), i);
+    });
+
+    std::vector<std::pair<unsigned, unsigned>> pares, todos;
+    double tree_ms = 0.0, brute_ms = 0.0;
+    size_t reinserted = 0, candidates = 0, overlapping = 0;
+
+    for (unsigned frame = 0; frame < frames; ++frame) {
+        for (auto& c : corpos) {
+            c.center += c.velocity;
+            for (int axis = 0; axis < 3; ++axis) {
+                if (c.center[axis] < 0.0f || c.center[axis] > side) c.velocity[axis] = -c.velocity[axis];
+            }
+        }
+
+        tree_ms += timeMs([&] {
+            for (unsigned i = 0; i < count; ++i) {
+                reinserted += cena.move(proxies[i], corpos[i].box(), corpos[i].velocity);
+            }
+            cena.updatePairs(pares);
+        });
+
+        brute_ms += timeMs([&] {
+            todos.clear();
+            for (unsigned i = 0; i < count; ++i) {
+                AABB a = corpos[i].box();
+                for (unsigned j = i + 1; j < count; ++j) {
+                    if (a.intersects(corpos[j].box())) todos.emplace_back(i, j);
+                }
+            }
+        });
+
+        candidates += pares.size();
+        overlapping += todos.size();
+    }
+
+    std::printf("objetos %u, quadros %u, margem %.2f, inserção %.2f ms, altura %d\n",
+                count, frames, margin, insert_ms, cena.height());
+    std::printf("%-12s %12s %12s %12s\n", "", "ms/quadro", "pares", "reinseridas");
+    std::printf("%-12s %12.3f %12.1f %12.1f\n", "dinâmica", tree_ms / frames,
+                (double)candidates / frames, (double)reinserted / frames);
+    std::printf("%-12s %12.3f %12.1f %12s\n", "todos pares", brute_ms / frames,
+                (double)overlapping / frames, "-");
+
+    return 0;
+}
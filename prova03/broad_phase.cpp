@@ -0,0 +1,361 @@
+#ifndef PROVA03_BROAD_PHASE_CPP
+#define PROVA03_BROAD_PHASE_CPP
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "aabb.cpp"
+
+// Fase ampla da cena: árvore AABB dinâmica com uma folha por objeto (caixa no
+// mundo alargada por margin). Mover um objeto só reinsere a folha quando a
+// caixa sai da alargada; inserir escolhe o irmão pelo custo de área e sobe
+// rebalanceando com rotações (Catto, Box2D b2DynamicTree). Só as folhas
+// movidas consultam a árvore por pares novos, então uma cena quase parada
+// custa pouco mais que percorrer a lista de pares.
+class DynamicAABBTree {
+public:
+    static constexpr unsigned null = ~0u;
+
+    explicit DynamicAABBTree(float fat_margin = 0.05f) : margin(fat_margin) {}
+
+    // Retorna o proxy da folha; object é devolvido nos pares
+    unsigned insert(const AABB& box, unsigned object) {
+        const unsigned leaf = allocate();
+        Node& n = nodes[leaf];
+        n.box = fatten(box, glm::vec3(0.0f));
+        n.object = object;
+        n.height = 0;
+        n.moved = true;
+
+        insertLeaf(leaf);
+        moved.push_back(leaf);
+        ++proxies;
+        return leaf;
+    }
+
+    void remove(unsigned proxy) {
+        assert(nodes[proxy].isLeaf());
+        unmark(proxy);
+        std::erase_if(proxy_pairs, [&](const std::pair<unsigned, unsigned>& p) {
+            return p.first == proxy || p.second == proxy;
+        });
+        removeLeaf(proxy);
+        release(proxy);
+        --proxies;
+    }
+
+    // box é a caixa justa atual; displacement (movimento previsto até o próximo
+    // quadro) estica a caixa alargada nessa direção. Retorna se reinseriu.
+    bool move(unsigned proxy, const AABB& box, const glm::vec3& displacement = glm::vec3(0.0f)) {
+        assert(nodes[proxy].isLeaf());
+        const AABB fat = fatten(box, displacement);
+        const AABB& current = nodes[proxy].box;
+
+        // Ainda cabe e a caixa antiga não ficou folgada demais (objeto que parou)
+        if (current.contains(box)) {
+            AABB huge(fat.min_corner - glm::vec3(4.0f * margin), fat.max_corner + glm::vec3(4.0f * margin));
+            if (huge.contains(current)) return false;
+        }
+
+        removeLeaf(proxy);
+        nodes[proxy].box = fat;
+        insertLeaf(proxy);
+
+        if (!nodes[proxy].moved) {
+            nodes[proxy].moved = true;
+            moved.push_back(proxy);
+        }
+        return true;
+    }
+
+    const AABB& fatBox(unsigned proxy) const { return nodes[proxy].box; }
+    unsigned object(unsigned proxy) const { return nodes[proxy].object; }
+    size_t proxyCount() const { return proxies; }
+    int height() const { return root == null ? 0 : nodes[root].height; }
+
+    // callback(proxy) para cada folha cuja caixa alargada cruza box; parar
+    // quando o callback retornar falso
+    template <typename Callback>
+    void query(const AABB& box, Callback&& callback) const {
+        if (root == null) return;
+
+        std::vector<unsigned>& stack = query_stack;
+        stack.clear();
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            const unsigned index = stack.back();
+            stack.pop_back();
+
+            const Node& n = nodes[index];
+            if (!n.box.intersects(box)) continue;
+
+            if (n.isLeaf()) {
+                if (!callback(index)) return;
+            }
+            else {
+                stack.push_back(n.left);
+                stack.push_back(n.right);
+            }
+        }
+    }
+
+    // Pares candidatos (object, object), menor primeiro e sem repetição: as
+    // folhas cujas caixas alargadas se cruzam. Só as folhas movidas desde a
+    // chamada anterior consultam a árvore; os pares entre folhas paradas vêm da
+    // lista mantida entre as chamadas.
+    void updatePairs(std::vector<std::pair<unsigned, unsigned>>& pairs) {
+        // Pares antigos em que uma das folhas se moveu para longe da outra
+        std::erase_if(proxy_pairs, [&](const std::pair<unsigned, unsigned>& p) {
+            const Node& a = nodes[p.first];
+            const Node& b = nodes[p.second];
+            return (a.moved || b.moved) && !a.box.intersects(b.box);
+        });
+
+        for (unsigned proxy : moved) {
+            query(nodes[proxy].box, [&](unsigned other) {
+                // Entre duas folhas movidas o par sai só de uma delas
+                if (other == proxy || (nodes[other].moved && other < proxy)) return true;
+                proxy_pairs.emplace_back(std::min(proxy, other), std::max(proxy, other));
+                return true;
+            });
+        }
+
+        for (unsigned proxy : moved) nodes[proxy].moved = false;
+        moved.clear();
+
+        std::sort(proxy_pairs.begin(), proxy_pairs.end());
+        proxy_pairs.erase(std::unique(proxy_pairs.begin(), proxy_pairs.end()), proxy_pairs.end());
+
+        pairs.clear();
+        pairs.reserve(proxy_pairs.size());
+        for (auto [a, b] : proxy_pairs) {
+            unsigned object_a = nodes[a].object, object_b = nodes[b].object;
+            pairs.emplace_back(std::min(object_a, object_b), std::max(object_a, object_b));
+        }
+    }
+
+private:
+    struct Node {
+        AABB box;
+        unsigned parent{null};   // próximo livre quando o nó está na lista livre
+        unsigned left{null};
+        unsigned right{null};
+        int height{-1};          // 0 em folhas, -1 em nós livres
+        unsigned object{null};
+        bool moved{false};
+
+        bool isLeaf() const { return left == null; }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<unsigned> moved;
+    std::vector<std::pair<unsigned, unsigned>> proxy_pairs;
+    mutable std::vector<unsigned> query_stack;
+    unsigned root{null};
+    unsigned free_list{null};
+    size_t proxies{0};
+    float margin;
+
+    AABB fatten(const AABB& box, const glm::vec3& displacement) const {
+        AABB fat(box.min_corner - glm::vec3(margin), box.max_corner + glm::vec3(margin));
+        fat.min_corner += glm::min(displacement, glm::vec3(0.0f));
+        fat.max_corner += glm::max(displacement, glm::vec3(0.0f));
+        return fat;
+    }
+
+    static AABB merge(const AABB& a, const AABB& b) {
+        AABB result = a;
+        result.expand(b);
+        return result;
+    }
+
+    unsigned allocate() {
+        if (free_list == null) {
+            nodes.emplace_back();
+            return unsigned(nodes.size() - 1);
+        }
+
+        const unsigned index = free_list;
+        free_list = nodes[index].parent;
+        nodes[index] = Node();
+        return index;
+    }
+
+    void release(unsigned index) {
+        nodes[index] = Node();
+        nodes[index].parent = free_list;
+        free_list = index;
+    }
+
+    void unmark(unsigned proxy) {
+        if (!nodes[proxy].moved) return;
+        nodes[proxy].moved = false;
+        moved.erase(std::find(moved.begin(), moved.end(), proxy));
+    }
+
+    // Desce pelo filho de menor custo de área até que parar ali seja mais
+    // barato: custo do novo pai mais o aumento herdado pelos ancestrais.
+    unsigned chooseSibling(const AABB& box) const {
+        unsigned index = root;
+
+        while (!nodes[index].isLeaf()) {
+            const Node& n = nodes[index];
+            const float area = n.box.surfaceArea();
+            const float combined = merge(n.box, box).surfaceArea();
+
+            const float cost = 2.0f * combined;
+            const float inherited = 2.0f * (combined - area);
+
+            auto descend = [&](unsigned child) {
+                const AABB& child_box = nodes[child].box;
+                float grown = merge(child_box, box).surfaceArea();
+                if (!nodes[child].isLeaf()) grown -= child_box.surfaceArea();
+                return grown + inherited;
+            };
+
+            const float cost_left = descend(n.left);
+            const float cost_right = descend(n.right);
+
+            if (cost < cost_left && cost < cost_right) break;
+            index = cost_left < cost_right ? n.left : n.right;
+        }
+
+        return index;
+    }
+
+    void insertLeaf(unsigned leaf) {
+        if (root == null) {
+            root = leaf;
+            nodes[leaf].parent = null;
+            return;
+        }
+
+        const unsigned sibling = chooseSibling(nodes[leaf].box);
+        const unsigned old_parent = nodes[sibling].parent;
+
+        const unsigned parent = allocate();
+        nodes[parent].parent = old_parent;
+        nodes[parent].box = merge(nodes[leaf].box, nodes[sibling].box);
+        nodes[parent].height = nodes[sibling].height + 1;
+        nodes[parent].left = sibling;
+        nodes[parent].right = leaf;
+        nodes[sibling].parent = parent;
+        nodes[leaf].parent = parent;
+
+        if (old_parent == null) {
+            root = parent;
+        }
+        else if (nodes[old_parent].left == sibling) {
+            nodes[old_parent].left = parent;
+        }
+        else {
+            nodes[old_parent].right = parent;
+        }
+
+        refitUpwards(parent);
+    }
+
+    void removeLeaf(unsigned leaf) {
+        if (leaf == root) {
+            root = null;
+            return;
+        }
+
+        const unsigned parent = nodes[leaf].parent;
+        const unsigned grand_parent = nodes[parent].parent;
+        const unsigned sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        release(parent);
+
+        if (grand_parent == null) {
+            root = sibling;
+            nodes[sibling].parent = null;
+            return;
+        }
+
+        if (nodes[grand_parent].left == parent) {
+            nodes[grand_parent].left = sibling;
+        }
+        else {
+            nodes[grand_parent].right = sibling;
+        }
+        nodes[sibling].parent = grand_parent;
+
+        refitUpwards(grand_parent);
+    }
+
+    // Rebalanceia e recalcula caixa e altura de index até a raiz
+    void refitUpwards(unsigned index) {
+        while (index != null) {
+            index = balance(index);
+
+            Node& n = nodes[index];
+            n.height = 1 + std::max(nodes[n.left].height, nodes[n.right].height);
+            n.box = merge(nodes[n.left].box, nodes[n.right].box);
+
+            index = n.parent;
+        }
+    }
+
+    // Se um filho de a está mais de um nível mais alto que o outro, o filho
+    // alto sobe para o lugar de a, e o neto mais baixo desce para baixo de a.
+    // Retorna a raiz da subárvore.
+    unsigned balance(unsigned a) {
+        Node& A = nodes[a];
+        if (A.isLeaf() || A.height < 2) return a;
+
+        const int difference = nodes[A.right].height - nodes[A.left].height;
+        if (difference > 1) return rotate(a, A.right, false);
+        if (difference < -1) return rotate(a, A.left, true);
+        return a;
+    }
+
+    // c é o filho alto de a (o esquerdo se c_is_left); retorna c
+    unsigned rotate(unsigned a, unsigned c, bool c_is_left) {
+        Node& A = nodes[a];
+        Node& C = nodes[c];
+        const unsigned f = C.left, g = C.right;
+
+        // c toma o lugar de a
+        C.left = a;
+        C.parent = A.parent;
+        A.parent = c;
+
+        if (C.parent == null) {
+            root = c;
+        }
+        else if (nodes[C.parent].left == a) {
+            nodes[C.parent].left = c;
+        }
+        else {
+            nodes[C.parent].right = c;
+        }
+
+        // O neto mais alto fica com c; o outro vai para o lugar de c em a
+        const bool keep_f = nodes[f].height > nodes[g].height;
+        const unsigned kept = keep_f ? f : g;
+        const unsigned moved_down = keep_f ? g : f;
+
+        C.right = kept;
+        if (c_is_left) {
+            A.left = moved_down;
+        }
+        else {
+            A.right = moved_down;
+        }
+        nodes[moved_down].parent = a;
+
+        A.box = merge(nodes[A.left].box, nodes[A.right].box);
+        A.height = 1 + std::max(nodes[A.left].height, nodes[A.right].height);
+        C.box = merge(A.box, nodes[kept].box);
+        C.height = 1 + std::max(A.height, nodes[kept].height);
+
+        return c;
+    }
+};
+
+#endif
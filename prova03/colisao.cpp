@@ -0,0 +1,842 @@
+#include <iostream>
+#include <cmath>
+#include <bit>
+#include <type_traits>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "obb.cpp"
+#include "quantized_bvh.cpp"
+#include "wide_bvh.cpp"
+
+// Trecho em que dois triângulos se cruzam. Triângulos coplanares se tocam
+// numa área: aí coplanar fica verdadeiro e inicio == fim é um ponto dela.
+struct SegmentoContato {
+    glm::vec3 inicio{0.0f};
+    glm::vec3 fim{0.0f};
+    bool coplanar{false};
+};
+
+// Distâncias (sem normalizar) até um plano que ficam abaixo de tolerancia
+// viram zero: o vértice está no plano
+inline void arredondaDistancias(glm::vec3& d, float tolerancia) {
+    for (int i = 0; i < 3; ++i) {
+        if (std::abs(d[i]) <= tolerancia) d[i] = 0.0f;
+    }
+}
+
+// Pontos em que as arestas de T cruzam o plano do outro triângulo, sendo d as
+// distâncias dos vértices de T a esse plano (que T atravessa ou toca).
+// Falso se T está inteiro no plano.
+inline bool cruzamentoPlano(const glm::vec3 (&T)[3], const glm::vec3& d, glm::vec3& p, glm::vec3& q) {
+    // Vértice sozinho de um lado do plano (ou o único fora dele)
+    int sozinho;
+    if (d[0] * d[1] > 0.0f) sozinho = 2;
+    else if (d[0] * d[2] > 0.0f) sozinho = 1;
+    else if (d[1] * d[2] > 0.0f || d[0] != 0.0f) sozinho = 0;
+    else if (d[1] != 0.0f) sozinho = 1;
+    else if (d[2] != 0.0f) sozinho = 2;
+    else return false;
+
+    const int i = (sozinho + 1) % 3, j = (sozinho + 2) % 3;
+    const glm::vec3& v = T[sozinho];
+    p = v + (T[i] - v) * (d[sozinho] / (d[sozinho] - d[i]));
+    q = v + (T[j] - v) * (d[sozinho] / (d[sozinho] - d[j]));
+    return true;
+}
+
+// Triângulos coplanares: projeta no plano dos dois eixos em que a normal é
+// menor e procura arestas que se cruzam ou um vértice dentro do outro.
+inline bool interceptaCoplanares(const glm::vec3 (&A)[3], const glm::vec3 (&B)[3], const glm::vec3& normal, SegmentoContato* segmento) {
+    const glm::vec3 n = glm::abs(normal);
+    const int u = n.x >= n.y && n.x >= n.z ? 1 : 0;
+    const int v = n.x >= n.y && n.x >= n.z ? 2 : (n.y >= n.z ? 2 : 1);
+
+    glm::vec2 a[3], b[3];
+    for (int k = 0; k < 3; ++k) {
+        a[k] = glm::vec2(A[k][u], A[k][v]);
+        b[k] = glm::vec2(B[k][u], B[k][v]);
+    }
+
+    auto orienta = [](const glm::vec2& p, const glm::vec2& q, const glm::vec2& r) {
+        return (q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x);
+    };
+
+    auto dentro = [&](const glm::vec2& p, const glm::vec2 (&T)[3]) {
+        float s0 = orienta(T[0], T[1], p), s1 = orienta(T[1], T[2], p), s2 = orienta(T[2], T[0], p);
+        return (s0 >= 0.0f && s1 >= 0.0f && s2 >= 0.0f) || (s0 <= 0.0f && s1 <= 0.0f && s2 <= 0.0f);
+    };
+
+    auto contato = [&](const glm::vec3& ponto) {
+        if (segmento) *segmento = {ponto, ponto, true};
+        return true;
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec2 &p0 = a[i], &p1 = a[(i + 1) % 3];
+        for (int j = 0; j < 3; ++j) {
+            const glm::vec2 &q0 = b[j], &q1 = b[(j + 1) % 3];
+            float o0 = orienta(p0, p1, q0), o1 = orienta(p0, p1, q1);
+            float o2 = orienta(q0, q1, p0), o3 = orienta(q0, q1, p1);
+            if (o0 * o1 > 0.0f || o2 * o3 > 0.0f) continue;
+
+            // Arestas colineares: um dos extremos fica dentro da outra aresta
+            if (o0 == 0.0f && o1 == 0.0f) {
+                auto entre = [](const glm::vec2& p, const glm::vec2& s0, const glm::vec2& s1) {
+                    return glm::all(glm::lessThanEqual(glm::min(s0, s1), p)) && glm::all(glm::lessThanEqual(p, glm::max(s0, s1)));
+                };
+                if (entre(p0, q0, q1)) return contato(A[i]);
+                if (entre(p1, q0, q1)) return contato(A[(i + 1) % 3]);
+                if (entre(q0, p0, p1)) return contato(B[j]);
+                continue;
+            }
+
+            float t = o2 / (o2 - o3);
+            return contato(A[i] + (A[(i + 1) % 3] - A[i]) * t);
+        }
+    }
+
+    if (dentro(a[0], b)) return contato(A[0]);
+    if (dentro(b[0], a)) return contato(B[0]);
+    return false;
+}
+
+// Teste exato de Möller ("A fast triangle-triangle intersection test", 1997):
+// rejeita pelos lados dos planos e compara os intervalos que cada triângulo
+// ocupa na reta de interseção dos planos, medidos nos pontos reais em que as
+// arestas cruzam o outro plano. segmento, se passado, recebe o trecho comum.
+inline bool interceptaTriangulo(const glm::vec3 (&A)[3], const glm::vec3 (&B)[3], SegmentoContato* segmento = nullptr) {
+    // Distâncias abaixo de ~8 ulp do tamanho do par são tratadas como zero
+    glm::vec3 low = glm::min(glm::min(glm::min(A[0], A[1]), glm::min(A[2], B[0])), glm::min(B[1], B[2]));
+    glm::vec3 high = glm::max(glm::max(glm::max(A[0], A[1]), glm::max(A[2], B[0])), glm::max(B[1], B[2]));
+    const glm::vec3 size = high - low;
+    const float escala = 1e-6f * std::max({size.x, size.y, size.z});
+
+    const glm::vec3 N1 = glm::cross(A[1] - A[0], A[2] - A[0]);
+    const glm::vec3 N2 = glm::cross(B[1] - B[0], B[2] - B[0]);
+    const float area1 = glm::length(N1), area2 = glm::length(N2);
+
+    // Triângulos degenerados não têm plano
+    if (area1 == 0.0f || area2 == 0.0f) return false;
+
+    glm::vec3 dB(glm::dot(N1, B[0] - A[0]), glm::dot(N1, B[1] - A[0]), glm::dot(N1, B[2] - A[0]));
+    arredondaDistancias(dB, escala * area1);
+    if ((dB[0] > 0.0f && dB[1] > 0.0f && dB[2] > 0.0f) || (dB[0] < 0.0f && dB[1] < 0.0f && dB[2] < 0.0f)) {
+        return false;
+    }
+
+    glm::vec3 dA(glm::dot(N2, A[0] - B[0]), glm::dot(N2, A[1] - B[0]), glm::dot(N2, A[2] - B[0]));
+    arredondaDistancias(dA, escala * area2);
+    if ((dA[0] > 0.0f && dA[1] > 0.0f && dA[2] > 0.0f) || (dA[0] < 0.0f && dA[1] < 0.0f && dA[2] < 0.0f)) {
+        return false;
+    }
+
+    glm::vec3 a0, a1, b0, b1;
+    if (!cruzamentoPlano(A, dA, a0, a1) || !cruzamentoPlano(B, dB, b0, b1)) {
+        return interceptaCoplanares(A, B, N1, segmento);
+    }
+
+    // Intervalos na reta de interseção, na direção D
+    const glm::vec3 D = glm::cross(N1, N2);
+    float ta0 = glm::dot(D, a0), ta1 = glm::dot(D, a1);
+    float tb0 = glm::dot(D, b0), tb1 = glm::dot(D, b1);
+    if (ta0 > ta1) std::swap(ta0, ta1), std::swap(a0, a1);
+    if (tb0 > tb1) std::swap(tb0, tb1), std::swap(b0, b1);
+
+    if (ta1 < tb0 || tb1 < ta0) return false;
+
+    if (segmento) {
+        segmento->inicio = ta0 >= tb0 ? a0 : b0;
+        segmento->fim = ta1 <= tb1 ? a1 : b1;
+        segmento->coplanar = false;
+    }
+    return true;
+}
+
+// Vértices de um objeto no espaço do mundo, calculados só quando uma folha
+// visitada pede e guardados enquanto a transformação e a versão da malha
+// (Mesh::version, que refit() troca) não mudam: todas as consultas do quadro
+// em que o objeto entra aproveitam os mesmos. Um vértice vale se
+// geracao[i] == atual; trocar de transformação ou de malha só incrementa
+// atual. Cada objeto precisa do seu próprio cache.
+struct VerticesMundo {
+    std::vector<glm::vec3> posicao;
+    std::vector<uint32_t> geracao;
+    uint32_t atual{0};
+    uint64_t versao{0};
+    const Mesh::coordinate_t* coords{nullptr};
+    glm::mat4 transform{1.0f};
+
+    // Passa a valer para a malha sob transform; mantém o que já foi calculado
+    // se nada mudou desde a última vez
+    void usa(const Mesh& malha, const glm::mat4& t) {
+        coords = malha.coordinates.get();
+        if (versao == malha.version && geracao.size() == coords->size() && transform == t && atual != 0) return;
+        versao = malha.version;
+        transform = t;
+        if (geracao.size() != coords->size()) {
+            posicao.resize(coords->size());
+            geracao.assign(coords->size(), 0);
+        }
+        if (++atual == 0) {
+            std::fill(geracao.begin(), geracao.end(), 0);
+            atual = 1;
+        }
+    }
+
+    const glm::vec3& operator[](unsigned i) {
+        if (geracao[i] != atual) {
+            posicao[i] = glm::vec3(transform * glm::vec4((*coords)[i], 1.0f));
+            geracao[i] = atual;
+        }
+        return posicao[i];
+    }
+};
+
+// Cache de um lado (0 ou 1) da consulta: o do chamador ou, sem ele, um por
+// thread, que só aproveita algo quando a mesma malha volta na mesma posição
+inline VerticesMundo* preparaCache(VerticesMundo* mundo, unsigned lado, const Mesh& malha, const glm::mat4& transform) {
+    thread_local VerticesMundo proprio[2];
+    if (!mundo) mundo = &proprio[lado];
+    mundo->usa(malha, transform);
+    return mundo;
+}
+
+// Testes feitos por verificaColisao, acumulados quando um ponteiro é passado
+struct EstatisticasColisao {
+    size_t testesCaixa{0};
+    size_t testesTriangulo{0};
+};
+
+// Par de triângulos (índices nas malhas de A e B) que se cruzam, com o
+// trecho de contato no mundo
+struct ParContato {
+    unsigned trianguloA;
+    unsigned trianguloB;
+    SegmentoContato segmento;
+};
+
+// Contatos reduzidos a até 4 pontos que cobrem a região tocada; normal vai
+// de A para B (média das normais de A menos as de B)
+struct ManifoldContato {
+    glm::vec3 pontos[4];
+    unsigned count{0};
+    glm::vec3 normal{0.0f};
+};
+
+// Qualquer: para no primeiro par que se cruza e o guarda em pares.
+// Todos: percorre tudo e guarda cada par em pares.
+// Manifold: percorre tudo e reduz os contatos a manifold.
+enum class ModoContato { Qualquer, Todos, Manifold };
+
+// Saída de verificaColisao quando um ponteiro é passado. O chamador mantém
+// a mesma entre consultas para reaproveitar a memória de pares e pontos.
+struct ContatosColisao {
+    ModoContato modo{ModoContato::Qualquer};
+    std::vector<ParContato> pares;
+    ManifoldContato manifold;
+    size_t total{0};
+
+    // Pontas dos segmentos, antes da redução do manifold
+    std::vector<glm::vec3> pontos;
+
+    void limpa() {
+        pares.clear();
+        pontos.clear();
+        manifold = ManifoldContato();
+        total = 0;
+    }
+
+    // Verdadeiro se a consulta pode parar
+    bool adiciona(const ParContato& par, const glm::vec3 (&a)[3], const glm::vec3 (&b)[3]) {
+        ++total;
+        if (modo != ModoContato::Manifold) {
+            pares.push_back(par);
+            return modo == ModoContato::Qualquer;
+        }
+
+        pontos.push_back(par.segmento.inicio);
+        if (!par.segmento.coplanar) pontos.push_back(par.segmento.fim);
+        manifold.normal += glm::normalize(glm::cross(a[1] - a[0], a[2] - a[0])) -
+                           glm::normalize(glm::cross(b[1] - b[0], b[2] - b[0]));
+        return false;
+    }
+
+    // Fecha a consulta: escolhe os pontos do manifold e diz se houve contato
+    bool termina() {
+        if (modo == ModoContato::Manifold && !pontos.empty()) {
+            const float comprimento = glm::length(manifold.normal);
+            if (comprimento > 0.0f) manifold.normal /= comprimento;
+            reduz();
+        }
+        return total > 0;
+    }
+
+    // Um ponto, o mais longe dele, o que forma o maior triângulo com os dois
+    // e o que mais aumenta a área coberta
+    void reduz() {
+        auto mais = [&](auto&& medida) {
+            size_t melhor = 0;
+            float valor = -1.0f;
+            for (size_t i = 0; i < pontos.size(); ++i) {
+                float m = medida(pontos[i]);
+                if (m > valor) valor = m, melhor = i;
+            }
+            return std::pair(pontos[melhor], valor);
+        };
+        auto area = [](const glm::vec3& p, const glm::vec3& q, const glm::vec3& r) {
+            return glm::length(glm::cross(q - p, r - p));
+        };
+
+        glm::vec3* P = manifold.pontos;
+        P[0] = pontos[0];
+        manifold.count = 1;
+
+        auto [p1, distancia] = mais([&](const glm::vec3& p) { return glm::dot(p - P[0], p - P[0]); });
+        if (distancia <= 0.0f) return;
+        P[manifold.count++] = p1;
+
+        auto [p2, area2] = mais([&](const glm::vec3& p) { return area(P[0], P[1], p); });
+        if (area2 <= 0.0f) return;
+        P[manifold.count++] = p2;
+
+        auto [p3, area3] = mais([&](const glm::vec3& p) { return area(P[0], P[1], p) + area(P[1], P[2], p) + area(P[2], P[0], p); });
+        if (area3 <= area2 * (1.0f + 1e-4f)) return;
+        P[manifold.count++] = p3;
+    }
+};
+
+// Mensagem de um par em contato, fora da travessia
+template <typename TreeA, typename TreeB>
+void imprimeContato(std::ostream& out, const ParContato& par, const TreeA& treeA, const TreeB& treeB) {
+    const auto& triA = treeA.triangle(par.trianguloA);
+    const auto& triB = treeB.triangle(par.trianguloB);
+    const glm::vec3 &p = par.segmento.inicio, &q = par.segmento.fim;
+    out << "Colisão detectada entre triângulos!" << std::endl;
+    out << "Triângulo A: " << triA[0] << ", " << triA[1] << ", " << triA[2] << std::endl;
+    out << "Triângulo B: " << triB[0] << ", " << triB[1] << ", " << triB[2] << std::endl;
+    if (par.segmento.coplanar) {
+        out << "Coplanares, ponto de contato: " << p.x << ", " << p.y << ", " << p.z << std::endl;
+    }
+    else {
+        out << "Segmento de contato: " << p.x << ", " << p.y << ", " << p.z << " -> " << q.x << ", " << q.y << ", " << q.z << std::endl;
+    }
+}
+
+inline bool sobrepoe(const AABB& a, const AABB& b) { return a.intersects(b); }
+inline bool sobrepoe(const OBB& a, const OBB& b) { return a.intersects(b); }
+inline bool sobrepoe(const AABB& a, const OBB& b) { return OBB(a).intersects(b); }
+
+// Dados fixos de uma consulta entre duas árvores (AABBTree ou OBBTree). As
+// caixas de B são levadas ao espaço local de A por relativa, só nos nós que a
+// travessia visita: viram OBB se alguma das árvores usa OBB, senão continuam
+// AABB. Os triângulos continuam sendo testados no espaço do mundo.
+template <typename TreeA, typename TreeB>
+struct ConsultaColisao {
+    using Caixa = std::conditional_t<std::is_same_v<typename TreeA::Volume, OBB> ||
+                                     std::is_same_v<typename TreeB::Volume, OBB>, OBB, AABB>;
+
+    const TreeA& treeA;
+    const TreeB& treeB;
+    VerticesMundo* mundoA;
+    VerticesMundo* mundoB;
+    glm::mat4 relativa;
+    EstatisticasColisao* stats;
+    ContatosColisao* contatos;
+
+    Caixa caixaB(unsigned nodeB) const {
+        return Caixa(treeB.volume(nodeB)).transform(relativa);
+    }
+};
+
+// Pistas dos testes em lote: 8 floats com AVX, 4 com SSE, 1 sem SIMD.
+// Comparações devolvem máscaras que mascara() converte em bits por pista.
+#if defined(__AVX__)
+struct Pistas {
+    using T = __m256;
+    static constexpr unsigned largura = 8;
+    static T set(float v) { return _mm256_set1_ps(v); }
+    static T load(const float* p) { return _mm256_loadu_ps(p); }
+    static T add(T a, T b) { return _mm256_add_ps(a, b); }
+    static T sub(T a, T b) { return _mm256_sub_ps(a, b); }
+    static T mul(T a, T b) { return _mm256_mul_ps(a, b); }
+    static T raiz(T a) { return _mm256_sqrt_ps(a); }
+    static T maior(T a, T b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static T e(T a, T b) { return _mm256_and_ps(a, b); }
+    static T ou(T a, T b) { return _mm256_or_ps(a, b); }
+    static unsigned mascara(T a) { return (unsigned)_mm256_movemask_ps(a); }
+};
+#elif defined(__SSE2__)
+struct Pistas {
+    using T = __m128;
+    static constexpr unsigned largura = 4;
+    static T set(float v) { return _mm_set1_ps(v); }
+    static T load(const float* p) { return _mm_loadu_ps(p); }
+    static T add(T a, T b) { return _mm_add_ps(a, b); }
+    static T sub(T a, T b) { return _mm_sub_ps(a, b); }
+    static T mul(T a, T b) { return _mm_mul_ps(a, b); }
+    static T raiz(T a) { return _mm_sqrt_ps(a); }
+    static T maior(T a, T b) { return _mm_cmpgt_ps(a, b); }
+    static T e(T a, T b) { return _mm_and_ps(a, b); }
+    static T ou(T a, T b) { return _mm_or_ps(a, b); }
+    static unsigned mascara(T a) { return (unsigned)_mm_movemask_ps(a); }
+};
+#else
+struct Pistas {
+    using T = float;
+    static constexpr unsigned largura = 1;
+    static T set(float v) { return v; }
+    static T load(const float* p) { return *p; }
+    static T add(T a, T b) { return a + b; }
+    static T sub(T a, T b) { return a - b; }
+    static T mul(T a, T b) { return a * b; }
+    static T raiz(T a) { return std::sqrt(a); }
+    static T maior(T a, T b) { return a > b ? 1.0f : 0.0f; }
+    static T e(T a, T b) { return a * b; }
+    static T ou(T a, T b) { return std::max(a, b); }
+    static unsigned mascara(T a) { return a != 0.0f; }
+};
+#endif
+
+// Triângulos de uma folha no mundo, em SoA: a coordenada e do vértice k do
+// triângulo i fica em v[k][e][i]. O fim é completado com zeros até um
+// múltiplo de Pistas::largura.
+struct FolhaMundo {
+    std::vector<float> v[3][3];
+    unsigned count{0};
+    AABB caixa;
+
+    template <typename Tree>
+    void carrega(const Tree& tree, std::span<const unsigned> triangulos, VerticesMundo& mundo) {
+        count = (unsigned)triangulos.size();
+        const size_t total = (count + Pistas::largura - 1) / Pistas::largura * Pistas::largura;
+        for (auto& vertice : v) {
+            for (auto& eixo : vertice) eixo.assign(total, 0.0f);
+        }
+
+        caixa = AABB();
+        for (unsigned i = 0; i < count; ++i) {
+            const auto& tri = tree.triangle(triangulos[i]);
+            for (int k = 0; k < 3; ++k) {
+                const glm::vec3& p = mundo[tri[k]];
+                v[k][0][i] = p.x;
+                v[k][1][i] = p.y;
+                v[k][2][i] = p.z;
+                caixa.expand(p);
+            }
+        }
+    }
+
+    glm::vec3 vertice(unsigned i, int k) const {
+        return glm::vec3(v[k][0][i], v[k][1][i], v[k][2][i]);
+    }
+};
+
+// Bit j: o triângulo primeiro + j de B não fica inteiro de um lado do plano
+// de a (normal N1), nem a de um lado do plano dele. As tolerâncias são as de
+// interceptaTriangulo com a escala do par de folhas, que é maior ou igual à
+// de cada par de triângulos: o lote nunca descarta um par que cruza.
+inline unsigned candidatosLote(const glm::vec3 (&a)[3], const glm::vec3& N1, float tolerancia1,
+                               const FolhaMundo& B, unsigned primeiro, float escala) {
+    using P = Pistas;
+    const P::T nx = P::set(N1.x), ny = P::set(N1.y), nz = P::set(N1.z);
+    const P::T tol1 = P::set(tolerancia1), menosTol1 = P::set(-tolerancia1);
+
+    P::T bx[3], by[3], bz[3], d[3];
+    for (int k = 0; k < 3; ++k) {
+        bx[k] = P::load(B.v[k][0].data() + primeiro);
+        by[k] = P::load(B.v[k][1].data() + primeiro);
+        bz[k] = P::load(B.v[k][2].data() + primeiro);
+        d[k] = P::add(P::add(P::mul(nx, P::sub(bx[k], P::set(a[0].x))),
+                             P::mul(ny, P::sub(by[k], P::set(a[0].y)))),
+                      P::mul(nz, P::sub(bz[k], P::set(a[0].z))));
+    }
+
+    P::T separado = P::ou(P::e(P::e(P::maior(d[0], tol1), P::maior(d[1], tol1)), P::maior(d[2], tol1)),
+                          P::e(P::e(P::maior(menosTol1, d[0]), P::maior(menosTol1, d[1])), P::maior(menosTol1, d[2])));
+
+    // Normal de cada triângulo de B
+    const P::T e1x = P::sub(bx[1], bx[0]), e1y = P::sub(by[1], by[0]), e1z = P::sub(bz[1], bz[0]);
+    const P::T e2x = P::sub(bx[2], bx[0]), e2y = P::sub(by[2], by[0]), e2z = P::sub(bz[2], bz[0]);
+    const P::T mx = P::sub(P::mul(e1y, e2z), P::mul(e1z, e2y));
+    const P::T my = P::sub(P::mul(e1z, e2x), P::mul(e1x, e2z));
+    const P::T mz = P::sub(P::mul(e1x, e2y), P::mul(e1y, e2x));
+
+    const P::T tol2 = P::mul(P::set(escala), P::raiz(P::add(P::add(P::mul(mx, mx), P::mul(my, my)), P::mul(mz, mz))));
+    const P::T menosTol2 = P::sub(P::set(0.0f), tol2);
+
+    for (int k = 0; k < 3; ++k) {
+        d[k] = P::add(P::add(P::mul(mx, P::sub(P::set(a[k].x), bx[0])),
+                             P::mul(my, P::sub(P::set(a[k].y), by[0]))),
+                      P::mul(mz, P::sub(P::set(a[k].z), bz[0])));
+    }
+
+    separado = P::ou(separado, P::e(P::e(P::maior(d[0], tol2), P::maior(d[1], tol2)), P::maior(d[2], tol2)));
+    separado = P::ou(separado, P::e(P::e(P::maior(menosTol2, d[0]), P::maior(menosTol2, d[1])), P::maior(menosTol2, d[2])));
+
+    return ~P::mascara(separado) & ((1u << P::largura) - 1);
+}
+
+// Todos os pares entre dois grupos de triângulos de folhas. Cada folha vai ao
+// mundo uma vez; cada triângulo de A descarta os de B pelos planos em lotes
+// de Pistas::largura, e só os que sobram passam pelo teste exato. Cada par
+// que se cruza vai para consulta.contatos; verdadeiro se a consulta pode parar.
+template <typename Consulta>
+bool verificaTriangulos(const Consulta& consulta, std::span<const unsigned> triangulosA, std::span<const unsigned> triangulosB) {
+    thread_local FolhaMundo A, B;
+    A.carrega(consulta.treeA, triangulosA, *consulta.mundoA);
+    B.carrega(consulta.treeB, triangulosB, *consulta.mundoB);
+
+    // Mesma escala de arredondamento de interceptaTriangulo, para o par de folhas
+    AABB uniao = A.caixa;
+    uniao.expand(B.caixa);
+    const glm::vec3 size = uniao.max_corner - uniao.min_corner;
+    const float escala = 1e-6f * std::max({size.x, size.y, size.z});
+
+    for (unsigned i = 0; i < A.count; ++i) {
+        const glm::vec3 a[3] = {A.vertice(i, 0), A.vertice(i, 1), A.vertice(i, 2)};
+        const glm::vec3 N1 = glm::cross(a[1] - a[0], a[2] - a[0]);
+        const float area1 = glm::length(N1);
+
+        for (unsigned primeiro = 0; primeiro < B.count; primeiro += Pistas::largura) {
+            const unsigned lote = std::min(Pistas::largura, B.count - primeiro);
+            if (consulta.stats) consulta.stats->testesTriangulo += lote;
+
+            // Triângulo degenerado não cruza nada
+            if (area1 == 0.0f) continue;
+
+            unsigned mask = candidatosLote(a, N1, escala * area1, B, primeiro, escala) & ((1u << lote) - 1);
+            for (; mask; mask &= mask - 1) {
+                const unsigned j = primeiro + std::countr_zero(mask);
+                const glm::vec3 b[3] = {B.vertice(j, 0), B.vertice(j, 1), B.vertice(j, 2)};
+
+                SegmentoContato segmento;
+                if (!interceptaTriangulo(a, b, &segmento)) continue;
+
+                if (!consulta.contatos) return true;
+                if (consulta.contatos->adiciona({triangulosA[i], triangulosB[j], segmento}, a, b)) return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Medida de uma caixa para decidir qual árvore descer: a área de superfície,
+// que não zera em caixas achatadas como o volume
+inline float tamanho(const AABB& a) { return a.surfaceArea(); }
+inline float tamanho(const OBB& a) {
+    return 8.0f * (a.extent.x * a.extent.y + a.extent.y * a.extent.z + a.extent.z * a.extent.x);
+}
+
+// Quanto duas caixas que se tocam se sobrepõem, só para ordenar a descida:
+// área da caixa comum entre AABBs; com OBB, a menor distância entre centros
+inline float sobreposicao(const AABB& a, const AABB& b) {
+    return AABB(glm::max(a.min_corner, b.min_corner), glm::min(a.max_corner, b.max_corner)).surfaceArea();
+}
+template <typename CaixaA, typename CaixaB>
+float sobreposicao(const CaixaA& a, const CaixaB& b) {
+    const glm::vec3 d = OBB(a).center - OBB(b).center;
+    return -glm::dot(d, d);
+}
+
+// Par de nós pendente; caixaB (já no espaço de A) já tocou a caixa de nodeA
+template <typename Caixa>
+struct ParNos {
+    unsigned nodeA;
+    unsigned nodeB;
+    Caixa caixaB;
+};
+
+// Travessia simultânea com pilha explícita. Cada par desce só o maior dos
+// dois nós (uma folha nunca desce), testa os dois filhos contra o outro nó e
+// empilha os que tocam, o de maior sobreposição por último para ser visitado
+// primeiro. Cada passo desce um nível numa das árvores e aumenta a pilha em
+// no máximo um par, então ela não passa de profundidadeA + profundidadeB + 1
+// pares. O array cobre árvores até AABBTree::depth_limit; além disso os pares
+// seguem num vetor.
+template <typename TreeA, typename TreeB>
+bool verificaColisao(const ConsultaColisao<TreeA, TreeB>& consulta) {
+    using Par = ParNos<typename ConsultaColisao<TreeA, TreeB>::Caixa>;
+    const TreeA& treeA = consulta.treeA;
+    const TreeB& treeB = consulta.treeB;
+
+    Par stack[2 * AABBTree::depth_limit + 1];
+    unsigned size = 0;
+    std::vector<Par> excedente;
+
+    auto push = [&](const Par& par) {
+        if (size < std::size(stack)) stack[size++] = par;
+        else excedente.push_back(par);
+    };
+
+    const Par raiz{TreeA::root, TreeB::root, consulta.caixaB(TreeB::root)};
+    if (consulta.stats) consulta.stats->testesCaixa++;
+    if (!sobrepoe(treeA.volume(raiz.nodeA), raiz.caixaB)) return false;
+    push(raiz);
+
+    while (size > 0) {
+        Par par;
+        if (excedente.empty()) {
+            par = stack[--size];
+        }
+        else {
+            par = excedente.back();
+            excedente.pop_back();
+        }
+        const AABBNode& a = treeA.node(par.nodeA);
+        const AABBNode& b = treeB.node(par.nodeB);
+
+        if (a.isLeaf() && b.isLeaf()) {
+            if (verificaTriangulos(consulta, treeA.triangles(a), treeB.triangles(b))) return true;
+            continue;
+        }
+
+        const bool desceA = b.isLeaf() || (!a.isLeaf() && tamanho(treeA.volume(par.nodeA)) >= tamanho(par.caixaB));
+        const unsigned pai = desceA ? par.nodeA : par.nodeB;
+        const unsigned filhos[2] = {desceA ? treeA.leftChild(pai) : treeB.leftChild(pai),
+                                    desceA ? treeA.rightChild(pai) : treeB.rightChild(pai)};
+
+        Par tocam[2];
+        float quanto[2];
+        unsigned count = 0;
+        for (unsigned filho : filhos) {
+            const Par novo = desceA ? Par{filho, par.nodeB, par.caixaB} : Par{par.nodeA, filho, consulta.caixaB(filho)};
+            const auto& caixaA = treeA.volume(novo.nodeA);
+
+            if (consulta.stats) consulta.stats->testesCaixa++;
+            if (!sobrepoe(caixaA, novo.caixaB)) continue;
+
+            quanto[count] = sobreposicao(caixaA, novo.caixaB);
+            tocam[count++] = novo;
+        }
+
+        if (count == 2 && quanto[0] > quanto[1]) std::swap(tocam[0], tocam[1]);
+        for (unsigned i = 0; i < count; ++i) push(tocam[i]);
+    }
+    return false;
+}
+
+template <typename TreeA, typename TreeB>
+bool verificaColisao(const TreeA& treeA, const TreeB& treeB, const glm::mat4& transformA, const glm::mat4& transformB, EstatisticasColisao* stats = nullptr,
+                     VerticesMundo* mundoA = nullptr, VerticesMundo* mundoB = nullptr, ContatosColisao* contatos = nullptr) {
+    if (contatos) contatos->limpa();
+    if (treeA.empty() || treeB.empty()) return false;
+
+    mundoA = preparaCache(mundoA, 0, treeA.getMesh(), transformA);
+    mundoB = preparaCache(mundoB, 1, treeB.getMesh(), transformB);
+
+    ConsultaColisao<TreeA, TreeB> consulta{treeA, treeB, mundoA, mundoB, glm::inverse(transformA) * transformB, stats, contatos};
+    const bool achou = verificaColisao(consulta);
+    return contatos ? contatos->termina() : achou;
+}
+
+// Consulta entre duas árvores largas. Cada filho de B vai para o espaço de A
+// por relativa e é testado contra todos os filhos de um nó de A de uma vez;
+// quando A chega numa folha, a caixa dela vai para o espaço de B por inversa
+// e os filhos de B passam a ser testados do mesmo jeito. Um teste de caixa
+// nas estatísticas cobre todos os filhos de um nó.
+template <unsigned Width>
+struct ConsultaLarga {
+    const WideBVH<Width>& treeA;
+    const WideBVH<Width>& treeB;
+    VerticesMundo* mundoA;
+    VerticesMundo* mundoB;
+    glm::mat4 relativa;
+    glm::mat4 inversa;
+    EstatisticasColisao* stats;
+    ContatosColisao* contatos;
+};
+
+template <unsigned Width>
+bool verificaColisao(const ConsultaLarga<Width>& consulta, unsigned nodeA, unsigned nodeB);
+
+// Par de folhas que já se tocam num dos espaços: as caixas transformadas
+// afrouxam com a rotação, então confere também no outro antes dos triângulos.
+template <unsigned Width>
+bool verificaFolhas(const ConsultaLarga<Width>& consulta, const WideNode<Width>& a, unsigned k,
+                    const WideNode<Width>& b, unsigned j, const AABB& caixaB) {
+    if (consulta.stats) consulta.stats->testesCaixa++;
+    if (!a.box(k).intersects(caixaB) || !a.box(k).transform(consulta.inversa).intersects(b.box(j))) return false;
+
+    return verificaTriangulos(consulta, consulta.treeA.triangles(a, k), consulta.treeB.triangles(b, j));
+}
+
+// Folha k de nodeA contra a subárvore de B em nodeB; caixaA no espaço de B
+template <unsigned Width>
+bool desceB(const ConsultaLarga<Width>& consulta, unsigned nodeA, unsigned k, const AABB& caixaA, unsigned nodeB) {
+    const auto& a = consulta.treeA.node(nodeA);
+    const auto& b = consulta.treeB.node(nodeB);
+
+    if (consulta.stats) consulta.stats->testesCaixa++;
+    for (unsigned mask = b.overlap(caixaA); mask; mask &= mask - 1) {
+        const unsigned j = std::countr_zero(mask);
+        if (b.isLeaf(j) ? verificaFolhas(consulta, a, k, b, j, b.box(j).transform(consulta.relativa))
+                        : desceB(consulta, nodeA, k, caixaA, b.child[j])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <unsigned Width>
+bool desceA(const ConsultaLarga<Width>& consulta, unsigned nodeA, unsigned nodeB, unsigned j, const AABB& caixaB);
+
+// Filho k de nodeA contra filho j de nodeB, cujas caixas já se tocam
+template <unsigned Width>
+bool verificaPar(const ConsultaLarga<Width>& consulta, unsigned nodeA, unsigned k, unsigned nodeB, unsigned j, const AABB& caixaB) {
+    const auto& a = consulta.treeA.node(nodeA);
+    const auto& b = consulta.treeB.node(nodeB);
+
+    if (a.isLeaf(k) && b.isLeaf(j)) {
+        return verificaFolhas(consulta, a, k, b, j, caixaB);
+    }
+    if (a.isLeaf(k)) {
+        return desceB(consulta, nodeA, k, a.box(k).transform(consulta.inversa), b.child[j]);
+    }
+    if (b.isLeaf(j)) {
+        return desceA(consulta, a.child[k], nodeB, j, caixaB);
+    }
+    return verificaColisao(consulta, a.child[k], b.child[j]);
+}
+
+// Filhos de nodeA contra o filho j de nodeB (caixaB, no espaço de A)
+template <unsigned Width>
+bool desceA(const ConsultaLarga<Width>& consulta, unsigned nodeA, unsigned nodeB, unsigned j, const AABB& caixaB) {
+    if (consulta.stats) consulta.stats->testesCaixa++;
+    for (unsigned mask = consulta.treeA.node(nodeA).overlap(caixaB); mask; mask &= mask - 1) {
+        if (verificaPar(consulta, nodeA, std::countr_zero(mask), nodeB, j, caixaB)) return true;
+    }
+    return false;
+}
+
+template <unsigned Width>
+bool verificaColisao(const ConsultaLarga<Width>& consulta, unsigned nodeA, unsigned nodeB) {
+    const auto& b = consulta.treeB.node(nodeB);
+    for (unsigned j = 0; j < b.children; ++j) {
+        if (desceA(consulta, nodeA, nodeB, j, b.box(j).transform(consulta.relativa))) return true;
+    }
+    return false;
+}
+
+template <unsigned Width>
+bool verificaColisao(const WideBVH<Width>& treeA, const WideBVH<Width>& treeB, const glm::mat4& transformA, const glm::mat4& transformB, EstatisticasColisao* stats = nullptr,
+                     VerticesMundo* mundoA = nullptr, VerticesMundo* mundoB = nullptr, ContatosColisao* contatos = nullptr) {
+    if (contatos) contatos->limpa();
+    if (treeA.empty() || treeB.empty()) return false;
+
+    mundoA = preparaCache(mundoA, 0, treeA.getMesh(), transformA);
+    mundoB = preparaCache(mundoB, 1, treeB.getMesh(), transformB);
+
+    glm::mat4 relativa = glm::inverse(transformA) * transformB;
+    ConsultaLarga<Width> consulta{treeA, treeB, mundoA, mundoB, relativa, glm::inverse(relativa), stats, contatos};
+    const bool achou = verificaColisao(consulta, WideBVH<Width>::root, WideBVH<Width>::root);
+    return contatos ? contatos->termina() : achou;
+}
+
+// Consulta entre duas árvores quantizadas: como a binária, mas cada nó chega
+// com a própria caixa já decodificada (caixaB no espaço de B e caixaBemA
+// levada ao de A por relativa), a partir da qual saem as dos filhos.
+struct ConsultaQuantizada {
+    const QuantizedBVH& treeA;
+    const QuantizedBVH& treeB;
+    VerticesMundo* mundoA;
+    VerticesMundo* mundoB;
+    glm::mat4 relativa;
+    EstatisticasColisao* stats;
+    ContatosColisao* contatos;
+};
+
+// Par pendente com as caixas decodificadas; caixaBemA já tocou caixaA
+struct ParQuantizado {
+    uint32_t refA;
+    uint32_t refB;
+    AABB caixaA;
+    AABB caixaB;
+    AABB caixaBemA;
+};
+
+// Mesma travessia da binária: desce o maior dos dois nós, decodifica as
+// caixas dos dois filhos e empilha os que tocam o outro nó, o de maior
+// sobreposição por último, com a mesma pilha limitada e o mesmo excedente.
+inline bool verificaColisao(const ConsultaQuantizada& consulta) {
+    const QuantizedBVH& treeA = consulta.treeA;
+    const QuantizedBVH& treeB = consulta.treeB;
+
+    ParQuantizado stack[2 * AABBTree::depth_limit + 1];
+    unsigned size = 0;
+    std::vector<ParQuantizado> excedente;
+
+    auto push = [&](const ParQuantizado& par) {
+        if (size < std::size(stack)) stack[size++] = par;
+        else excedente.push_back(par);
+    };
+
+    const ParQuantizado raiz{treeA.rootRef(), treeB.rootRef(), treeA.rootBox(), treeB.rootBox(),
+                             treeB.rootBox().transform(consulta.relativa)};
+    if (consulta.stats) consulta.stats->testesCaixa++;
+    if (!raiz.caixaA.intersects(raiz.caixaBemA)) return false;
+    push(raiz);
+
+    while (size > 0) {
+        ParQuantizado par;
+        if (excedente.empty()) {
+            par = stack[--size];
+        }
+        else {
+            par = excedente.back();
+            excedente.pop_back();
+        }
+
+        const bool folhaA = QuantizedBVH::isLeaf(par.refA);
+        const bool folhaB = QuantizedBVH::isLeaf(par.refB);
+
+        if (folhaA && folhaB) {
+            if (verificaTriangulos(consulta, treeA.triangles(par.refA), treeB.triangles(par.refB))) return true;
+            continue;
+        }
+
+        const bool desceA = folhaB || (!folhaA && tamanho(par.caixaA) >= tamanho(par.caixaBemA));
+        const QuantizedNode& pai = desceA ? treeA.node(par.refA) : treeB.node(par.refB);
+
+        ParQuantizado tocam[2];
+        float quanto[2];
+        unsigned count = 0;
+        for (unsigned lado = 0; lado < 2; ++lado) {
+            ParQuantizado novo = par;
+            if (desceA) {
+                novo.refA = pai.child[lado];
+                novo.caixaA = QuantizedBVH::childBox(pai, lado, par.caixaA);
+            }
+            else {
+                novo.refB = pai.child[lado];
+                novo.caixaB = QuantizedBVH::childBox(pai, lado, par.caixaB);
+                novo.caixaBemA = novo.caixaB.transform(consulta.relativa);
+            }
+
+            if (consulta.stats) consulta.stats->testesCaixa++;
+            if (!novo.caixaA.intersects(novo.caixaBemA)) continue;
+
+            quanto[count] = sobreposicao(novo.caixaA, novo.caixaBemA);
+            tocam[count++] = novo;
+        }
+
+        if (count == 2 && quanto[0] > quanto[1]) std::swap(tocam[0], tocam[1]);
+        for (unsigned i = 0; i < count; ++i) push(tocam[i]);
+    }
+    return false;
+}
+
+inline bool verificaColisao(const QuantizedBVH& treeA, const QuantizedBVH& treeB, const glm::mat4& transformA, const glm::mat4& transformB, EstatisticasColisao* stats = nullptr,
+                            VerticesMundo* mundoA = nullptr, VerticesMundo* mundoB = nullptr, ContatosColisao* contatos = nullptr) {
+    if (contatos) contatos->limpa();
+    if (treeA.empty() || treeB.empty()) return false;
+
+    mundoA = preparaCache(mundoA, 0, treeA.getMesh(), transformA);
+    mundoB = preparaCache(mundoB, 1, treeB.getMesh(), transformB);
+
+    ConsultaQuantizada consulta{treeA, treeB, mundoA, mundoB, glm::inverse(transformA) * transformB, stats, contatos};
+    const bool achou = verificaColisao(consulta);
+    return contatos ? contatos->termina() : achou;
+}
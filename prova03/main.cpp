@@ -3,6 +3,7 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <variant>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -10,14 +11,16 @@
 #include <GL/gl.h>
 #include <GLFW/glfw3.h>
 
-#include "aabb.cpp"
+#include "broad_phase.cpp"
+#include "colisao.cpp"
+#include "tree_cache.cpp"
+#include "mesh_cache.hpp"
+#include "profile.hpp"
 
-struct Objeto {
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec3> normals;
-    std::vector<std::array<unsigned, 3>> triangles;
+// vertices e triangles vêm do IndexedMesh (cache mapeado ou parse)
+struct Objeto : objloader::IndexedMesh {
     glm::mat4 modelMat;
-    GLuint vao, vbo[2];
+    GLuint vao, vbo;
     GLuint ebo;
 };
 
@@ -59,192 +62,12 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     }
 }
 
+// Colisão e shader só usam posições: normais e texturas nem são lidas
 bool loadOBJ(const std::string& path, Objeto& obj) {
-    std::ifstream file(path);
-    if (!file) {
-        std::cerr << "Erro ao abrir arquivo: " << path << std::endl;
-        return false;
-    }
-
-    std::vector<glm::vec3> temp_positions;
-    std::vector<glm::vec3> temp_normals;
-
-    std::unordered_map<std::string, unsigned> index_map;
-    unsigned current_index = 0;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-
-        if (line.rfind("v ", 0) == 0) {
-            glm::vec3 pos;
-            iss.ignore(2);
-            iss >> pos.x >> pos.y >> pos.z;
-            temp_positions.push_back(pos);
-        }
-        else if (line.rfind("vn ", 0) == 0) {
-            glm::vec3 norm;
-            iss.ignore(3);
-            iss >> norm.x >> norm.y >> norm.z;
-            temp_normals.push_back(glm::normalize(norm));
-        }
-        else if (line.rfind("f ", 0) == 0) {
-            iss.ignore(2);
-            std::string v_str[3];
-            iss >> v_str[0] >> v_str[1] >> v_str[2];
-
-            std::array<unsigned, 3> tri;
-
-            for (int i = 0; i < 3; ++i) {
-                if (index_map.find(v_str[i]) == index_map.end()) {
-                    int vi = 0, ti = 0, ni = 0;
-                    int matches = std::sscanf(v_str[i].c_str(), "%d/%d/%d", &vi, &ti, &ni);
-
-                    if (matches < 1) {
-                        std::cerr << "Formato inválido de face: " << v_str[i] << std::endl;
-                        continue;
-                    }
-
-                    if (vi < 0) vi = (int)temp_positions.size() + vi + 1;
-                    if (vi <= 0 || vi > (int)temp_positions.size()) {
-                        std::cerr << "Índice de posição fora do intervalo: " << vi << std::endl;
-                        continue;
-                    }
-
-                    glm::vec3 position = temp_positions[vi - 1];
-                    obj.vertices.push_back(position);
-
-                    if (matches == 3 && ni > 0 && ni <= (int)temp_normals.size()) {
-                        glm::vec3 normal = temp_normals[ni - 1];
-                        obj.normals.push_back(normal);
-                    } else {
-                        obj.normals.push_back(glm::vec3(0.0f));
-                    }
-
-                    index_map[v_str[i]] = current_index++;
-                }
-
-                tri[i] = index_map[v_str[i]];
-            }
-
-            if (obj.normals[tri[0]] == glm::vec3(0.0f) &&
-                obj.normals[tri[1]] == glm::vec3(0.0f) &&
-                obj.normals[tri[2]] == glm::vec3(0.0f)) {
-
-                glm::vec3 v0 = obj.vertices[tri[0]];
-                glm::vec3 v1 = obj.vertices[tri[1]];
-                glm::vec3 v2 = obj.vertices[tri[2]];
-
-                glm::vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
-
-                obj.normals[tri[0]] = normal;
-                obj.normals[tri[1]] = normal;
-                obj.normals[tri[2]] = normal;
-            }
-
-            obj.triangles.push_back(tri);
-        }
-    }
-
-    return true;
+    return objloader::loadCached(path, obj, {.attributes = objloader::Positions});
 }
 
-bool interceptaTriangulo(const std::array<unsigned, 3>& triA, const std::vector<glm::vec3>& coordsA, const glm::mat4& transformA, const std::array<unsigned, 3>& triB, const std::vector<glm::vec3>& coordsB, const glm::mat4& transformB) {
-    glm::vec3 A0 = glm::vec3(transformA * glm::vec4(coordsA[triA[0]], 1.0f));
-    glm::vec3 A1 = glm::vec3(transformA * glm::vec4(coordsA[triA[1]], 1.0f));
-    glm::vec3 A2 = glm::vec3(transformA * glm::vec4(coordsA[triA[2]], 1.0f));
-
-    glm::vec3 B0 = glm::vec3(transformB * glm::vec4(coordsB[triB[0]], 1.0f));
-    glm::vec3 B1 = glm::vec3(transformB * glm::vec4(coordsB[triB[1]], 1.0f));
-    glm::vec3 B2 = glm::vec3(transformB * glm::vec4(coordsB[triB[2]], 1.0f));
-
-    glm::vec3 N1 = glm::cross(A1 - A0, A2 - A0);
-    float d1 = -glm::dot(N1, A0);
-
-    float distB0 = glm::dot(N1, B0) + d1;
-    float distB1 = glm::dot(N1, B1) + d1;
-    float distB2 = glm::dot(N1, B2) + d1;
-
-    if ((distB0 > 0 && distB1 > 0 && distB2 > 0) ||
-        (distB0 < 0 && distB1 < 0 && distB2 < 0))
-        return false;
-
-    glm::vec3 N2 = glm::cross(B1 - B0, B2 - B0);
-    float d2 = -glm::dot(N2, B0);
-
-    float distA0 = glm::dot(N2, A0) + d2;
-    float distA1 = glm::dot(N2, A1) + d2;
-    float distA2 = glm::dot(N2, A2) + d2;
-
-    if ((distA0 > 0 && distA1 > 0 && distA2 > 0) || (distA0 < 0 && distA1 < 0 && distA2 < 0)){
-        return false;
-    }
-
-    glm::vec3 D = glm::cross(N1, N2);
-
-    int axis;
-    if (fabs(D.x) > fabs(D.y) && fabs(D.x) > fabs(D.z)){
-        axis = 0;
-    }
-    else if (fabs(D.y) > fabs(D.z)) {
-        axis = 1;
-    }
-    else {
-        axis = 2;
-    }
-
-    auto project = [axis](const glm::vec3& v) {
-        return (axis == 0) ? v.x : (axis == 1) ? v.y : v.z;
-    };
-
-    float a0 = project(A0), a1 = project(A1), a2 = project(A2);
-    float b0 = project(B0), b1 = project(B1), b2 = project(B2);
-
-    float minA = std::min({a0, a1, a2});
-    float maxA = std::max({a0, a1, a2});
-    float minB = std::min({b0, b1, b2});
-    float maxB = std::max({b0, b1, b2});
-
-    return maxA >= minB && maxB >= minA;
-}
-
-bool verificaColisao(AABBNode* nodeA, AABBNode* nodeB, const glm::mat4& transformA, const glm::mat4& transformB) {
-    if (!nodeA || !nodeB) return false;
-
-    if (!nodeA->transformed_aabb.intersects(nodeB->transformed_aabb))
-        return false;
-
-    if (nodeA->isLeaf() && nodeB->isLeaf()) {
-        for (const auto& triA : nodeA->mesh.triangles) {
-            for (const auto& triB : nodeB->mesh.triangles) {
-                if (interceptaTriangulo(triA, *nodeA->mesh.coordinates, transformA, triB, *nodeB->mesh.coordinates, transformB)) {
-                    std::cout << "Colisão detectada entre triângulos!" << std::endl;
-                    std::cout << "Triângulo A: " << triA[0] << ", " << triA[1] << ", " << triA[2] << std::endl;
-                    std::cout << "Triângulo B: " << triB[0] << ", " << triB[1] << ", " << triB[2] << std::endl;
-                    return true;
-                }
-            }
-        }
-        return false;
-    }
-
-    if (!nodeA->isLeaf() && !nodeB->isLeaf()) {
-        return verificaColisao(nodeA->left_child.get(), nodeB->left_child.get(), transformA, transformB) ||
-               verificaColisao(nodeA->left_child.get(), nodeB->right_child.get(), transformA, transformB) ||
-               verificaColisao(nodeA->right_child.get(), nodeB->left_child.get(), transformA, transformB) ||
-               verificaColisao(nodeA->right_child.get(), nodeB->right_child.get(), transformA, transformB);
-    } 
-    else if (!nodeA->isLeaf()) {
-        return verificaColisao(nodeA->left_child.get(), nodeB, transformA, transformB) ||
-               verificaColisao(nodeA->right_child.get(), nodeB, transformA, transformB);
-    } 
-    else { 
-        return verificaColisao(nodeA, nodeB->left_child.get(), transformA, transformB) ||
-               verificaColisao(nodeA, nodeB->right_child.get(), transformA, transformB);
-    }
-}
-
-glm::vec3 calcularTamanho(const std::vector<glm::vec3>& vertices) {
+glm::vec3 calcularTamanho(std::span<const glm::vec3> vertices) {
     glm::vec3 min = vertices[0];
     glm::vec3 max = vertices[0];
 
@@ -261,8 +84,10 @@ float comprimentoMaximo(const glm::vec3& tamanho) {
 }
 
 int main(int argc, char** argv) {
-    if (argc < 2) {
-        std::cerr << "Uso: " << argv[0] << " <modelo.obj>" << std::endl;
+    argc = objloader::profile::init(argc, argv);
+
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " <a.obj> <b.obj> [aabb|obb] [aabb|obb]" << std::endl;
         return 1;
     }
 
@@ -310,20 +135,14 @@ int main(int argc, char** argv) {
         glGenVertexArrays(1, &obj.vao);
         glBindVertexArray(obj.vao);
 
-        glGenBuffers(2, obj.vbo);
+        glGenBuffers(1, &obj.vbo);
 
         // VBO de posições
-        glBindBuffer(GL_ARRAY_BUFFER, obj.vbo[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, obj.vbo);
         glBufferData(GL_ARRAY_BUFFER, obj.vertices.size() * sizeof(glm::vec3), obj.vertices.data(), GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-        // VBO de normais
-        glBindBuffer(GL_ARRAY_BUFFER, obj.vbo[1]);
-        glBufferData(GL_ARRAY_BUFFER, obj.normals.size() * sizeof(glm::vec3), obj.normals.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
         // EBO de índices (triângulos)
         glGenBuffers(1, &obj.ebo);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj.ebo);
@@ -396,11 +215,47 @@ int main(int argc, char** argv) {
 
     float modelAngle = 0.0f; 
 
-    std::vector<AABBTree> trees;
-    for (auto& obj : objetos) {
-        auto mesh = std::make_shared<std::vector<glm::vec3>>(obj.vertices);
-        trees.emplace_back(Mesh(mesh, obj.triangles));
-        trees.back().build();
+    // Volume envolvente de cada objeto: argv[3] e argv[4], AABB por padrão
+    std::vector<std::variant<AABBTree, OBBTree>> trees;
+    for (size_t i = 0; i < objetos.size(); ++i) {
+        Objeto& obj = objetos[i];
+        auto mesh = std::make_shared<std::vector<glm::vec3>>(obj.vertices.begin(), obj.vertices.end());
+        Mesh m(mesh, Mesh::triangles_t(obj.triangles.begin(), obj.triangles.end()));
+
+        if (argc > 3 + (int)i && std::string(argv[3 + i]) == "obb") {
+            trees.emplace_back(std::in_place_type<OBBTree>, std::move(m));
+        }
+        else {
+            trees.emplace_back(std::in_place_type<AABBTree>, std::move(m));
+        }
+
+        // Modelos estáticos: a AABBTree é lida de "<obj>.bvh" quando a malha não mudou
+        if (auto* tree = std::get_if<AABBTree>(&trees.back())) {
+            loadTreeCached(argv[1 + i], *tree);
+        }
+        else {
+            objloader::profile::ScopedTimer timer(objloader::profile::Phase::TreeBuild);
+            std::get<OBBTree>(trees.back()).build();
+        }
+    }
+
+    // Fase ampla: cada objeto entra na cena com a caixa da malha (espaço do
+    // modelo) e a cada quadro passa a caixa transformada por modelMat; só os
+    // pares que ela devolve descem às árvores.
+    DynamicAABBTree cena;
+    std::vector<unsigned> proxies;
+    std::vector<std::pair<unsigned, unsigned>> pares;
+
+    // Vértices no mundo de cada objeto, compartilhados pelos pares do quadro
+    std::vector<VerticesMundo> mundo(trees.size());
+    ContatosColisao contatos;
+
+    auto caixaMundo = [&](size_t i, const glm::mat4& modelMat) {
+        return std::visit([&](const auto& tree) { return tree.getMesh().aabb.transform(modelMat); }, trees[i]);
+    };
+
+    for (size_t i = 0; i < trees.size(); ++i) {
+        proxies.push_back(cena.insert(caixaMundo(i, glm::mat4(1.0f)), (unsigned)i));
     }
 
     while (!glfwWindowShouldClose(window)) {
@@ -430,16 +285,23 @@ int main(int argc, char** argv) {
 
             obj.modelMat = translacaoLateral * Tb * R * S * To;
 
-            trees[i].updateTransform(obj.modelMat);
-
             glm::mat4 mvMat = viewMat * obj.modelMat;
             glUniformMatrix4fv(mvLoc, 1, GL_FALSE, glm::value_ptr(mvMat));
             glBindVertexArray(obj.vao);
             glDrawElements(GL_TRIANGLES, obj.triangles.size() * 3, GL_UNSIGNED_INT, 0);
         }
 
-        if (trees.size() >= 2) {
-            verificaColisao(trees[0].getRoot(), trees[1].getRoot(), objetos[0].modelMat, objetos[1].modelMat);
+        for (size_t i = 0; i < objetos.size(); ++i) {
+            cena.move(proxies[i], caixaMundo(i, objetos[i].modelMat));
+        }
+
+        cena.updatePairs(pares);
+        for (auto [a, b] : pares) {
+            std::visit([&](const auto& treeA, const auto& treeB) {
+                if (verificaColisao(treeA, treeB, objetos[a].modelMat, objetos[b].modelMat, nullptr, &mundo[a], &mundo[b], &contatos)) {
+                    imprimeContato(std::cout, contatos.pares.front(), treeA, treeB);
+                }
+            }, trees[a], trees[b]);
         }
 
         glfwSwapBuffers(window);
@@ -0,0 +1,210 @@
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "aabb.cpp"
+
+// Caixa orientada: centro, eixos ortonormais (colunas de axes) e meia-extensão
+// ao longo de cada eixo.
+struct OBB {
+    glm::vec3 center{0.0f};
+    glm::mat3 axes{1.0f};
+    glm::vec3 extent{0.0f};
+
+    OBB() = default;
+
+    OBB(const glm::vec3& c, const glm::mat3& a, const glm::vec3& e) :
+        center(c), axes(a), extent(e) {}
+
+    explicit OBB(const AABB& box) :
+        center((box.min_corner + box.max_corner) * 0.5f), extent((box.max_corner - box.min_corner) * 0.5f) {}
+
+    float volume() const {
+        return 8.0f * extent.x * extent.y * extent.z;
+    }
+
+    // Vale para rotação, translação e escala uniforme (as matrizes do prova03):
+    // os eixos continuam ortogonais e só muda o comprimento de cada um.
+    OBB transform(const glm::mat4& matrix) const {
+        glm::mat3 linear(matrix);
+        OBB result;
+        result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+
+        for (int i = 0; i < 3; ++i) {
+            glm::vec3 axis = linear * axes[i];
+            float length = glm::length(axis);
+            result.axes[i] = length > 0.0f ? axis / length : axes[i];
+            result.extent[i] = extent[i] * length;
+        }
+
+        return result;
+    }
+
+    // Teorema do eixo separador: 3 eixos de cada caixa e os 9 produtos
+    // vetoriais entre eles (Gottschalk et al., "OBBTree", 1996).
+    bool intersects(const OBB& other) const {
+        // Evita eixos nulos quando há arestas quase paralelas
+        constexpr float epsilon = 1e-6f;
+
+        // R[i][j]: eixo i desta caixa no eixo j da outra
+        float R[3][3], absR[3][3];
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                R[i][j] = glm::dot(axes[i], other.axes[j]);
+                absR[i][j] = std::abs(R[i][j]) + epsilon;
+            }
+        }
+
+        glm::vec3 d = other.center - center;
+        float t[3] = {glm::dot(d, axes[0]), glm::dot(d, axes[1]), glm::dot(d, axes[2])};
+        const glm::vec3& a = extent;
+        const glm::vec3& b = other.extent;
+
+        for (int i = 0; i < 3; ++i) {
+            float rb = b[0] * absR[i][0] + b[1] * absR[i][1] + b[2] * absR[i][2];
+            if (std::abs(t[i]) > a[i] + rb) return false;
+        }
+
+        for (int j = 0; j < 3; ++j) {
+            float ra = a[0] * absR[0][j] + a[1] * absR[1][j] + a[2] * absR[2][j];
+            float dist = t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j];
+            if (std::abs(dist) > ra + b[j]) return false;
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            for (int j = 0; j < 3; ++j) {
+                int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                float ra = a[i1] * absR[i2][j] + a[i2] * absR[i1][j];
+                float rb = b[j1] * absR[i][j2] + b[j2] * absR[i][j1];
+                float dist = t[i2] * R[i1][j] - t[i1] * R[i2][j];
+                if (std::abs(dist) > ra + rb) return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+// Autovetores (colunas) de uma matriz simétrica 3x3 por rotações de Jacobi.
+inline glm::dmat3 symmetricEigenvectors(glm::dmat3 a) {
+    glm::dmat3 v(1.0);
+
+    for (int iteration = 0; iteration < 32; ++iteration) {
+        // Maior elemento fora da diagonal
+        int p = 0, q = 1;
+        if (std::abs(a[0][2]) > std::abs(a[p][q])) p = 0, q = 2;
+        if (std::abs(a[1][2]) > std::abs(a[p][q])) p = 1, q = 2;
+
+        double scale = std::abs(a[0][0]) + std::abs(a[1][1]) + std::abs(a[2][2]);
+        if (std::abs(a[p][q]) <= 1e-12 * scale) break;
+
+        double r = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+        double t = r >= 0.0 ? 1.0 / (r + std::sqrt(1.0 + r * r)) : -1.0 / (-r + std::sqrt(1.0 + r * r));
+        double c = 1.0 / std::sqrt(1.0 + t * t);
+        double s = t * c;
+
+        glm::dmat3 rotation(1.0);
+        rotation[p][p] = c;
+        rotation[q][p] = s;
+        rotation[p][q] = -s;
+        rotation[q][q] = c;
+
+        a = glm::transpose(rotation) * a * rotation;
+        v = v * rotation;
+    }
+
+    return v;
+}
+
+// Mesma topologia (e mesmas estratégias de corte) do AABBTree, com uma OBB
+// ajustada por PCA para cada nó. Mais cara de construir e de testar, mas não
+// afrouxa quando o objeto gira, ao contrário da AABB transformada.
+class OBBTree {
+    AABBTree tree;
+    std::vector<OBB> boxes;
+
+    // Malhas a partir disso ajustam as caixas no pool
+    static constexpr unsigned parallel_cutoff = 1u << 14;
+
+public:
+    using Volume = OBB;
+    static constexpr unsigned root = AABBTree::root;
+
+    OBBTree(Mesh m, SplitStrategy split = SplitStrategy::Median) : tree(std::move(m), split) {}
+
+    void build(objloader::ThreadPool* pool = &objloader::ThreadPool::shared()) {
+        tree.build(pool);
+        boxes.resize(tree.nodeCount());
+
+        const unsigned count = (unsigned)boxes.size();
+        if (!pool || pool->size() < 2 || tree.getMesh().triangles.size() < parallel_cutoff) {
+            for (unsigned i = 0; i < count; ++i) boxes[i] = fit(i);
+            return;
+        }
+
+        // Os nós grandes ficam no começo: blocos intercalados equilibram a carga
+        const unsigned blocks = pool->size() * 16;
+        pool->parallelFor(blocks, [&](size_t k) {
+            for (unsigned i = (unsigned)k; i < count; i += blocks) boxes[i] = fit(i);
+        });
+    }
+
+    bool empty() const { return tree.empty(); }
+    size_t nodeCount() const { return tree.nodeCount(); }
+    size_t memoryBytes() const { return tree.memoryBytes() + boxes.capacity() * sizeof(OBB); }
+    const AABBNode& node(unsigned index) const { return tree.node(index); }
+    const OBB& volume(unsigned index) const { return boxes[index]; }
+    unsigned leftChild(unsigned index) const { return tree.leftChild(index); }
+    unsigned rightChild(unsigned index) const { return tree.rightChild(index); }
+
+    const Mesh& getMesh() const { return tree.getMesh(); }
+    const Mesh::coordinate_t& coordinates() const { return tree.coordinates(); }
+    std::span<const unsigned> triangles(const AABBNode& node) const { return tree.triangles(node); }
+    const std::array<unsigned, 3>& triangle(unsigned index) const { return tree.triangle(index); }
+
+private:
+    // Eixos: autovetores da covariância dos triângulos do nó ponderada pela
+    // área; extensão: projeção dos vértices nesses eixos. Fica com a caixa
+    // alinhada se ela for menor (malhas já alinhadas aos eixos).
+    OBB fit(unsigned index) const {
+        const AABBNode& n = tree.node(index);
+        const auto& coords = tree.coordinates();
+
+        double total_area = 0.0;
+        glm::dvec3 mean(0.0);
+        glm::dmat3 moment(0.0);
+
+        for (unsigned t : tree.triangles(n)) {
+            const auto& tri = tree.triangle(t);
+            glm::dvec3 p(coords[tri[0]]), q(coords[tri[1]]), r(coords[tri[2]]);
+            glm::dvec3 c = (p + q + r) / 3.0;
+            double area = 0.5 * glm::length(glm::cross(q - p, r - p));
+
+            total_area += area;
+            mean += area * c;
+            moment += (area / 12.0) * (9.0 * glm::outerProduct(c, c) + glm::outerProduct(p, p) +
+                                       glm::outerProduct(q, q) + glm::outerProduct(r, r));
+        }
+
+        glm::mat3 axes(1.0f);
+        if (total_area > 0.0) {
+            mean /= total_area;
+            axes = glm::mat3(symmetricEigenvectors(moment / total_area - glm::outerProduct(mean, mean)));
+        }
+
+        glm::vec3 low(std::numeric_limits<float>::max());
+        glm::vec3 high(std::numeric_limits<float>::lowest());
+        glm::mat3 project = glm::transpose(axes);
+        for (unsigned t : tree.triangles(n)) {
+            for (auto idx : tree.triangle(t)) {
+                glm::vec3 local = project * coords[idx];
+                low = glm::min(low, local);
+                high = glm::max(high, local);
+            }
+        }
+
+        OBB box(axes * ((low + high) * 0.5f), axes, (high - low) * 0.5f);
+        OBB aligned(n.original_aabb);
+        return aligned.volume() <= box.volume() ? aligned : box;
+    }
+};
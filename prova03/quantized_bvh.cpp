@@ -0,0 +1,208 @@
+#ifndef PROVA03_QUANTIZED_BVH_CPP
+#define PROVA03_QUANTIZED_BVH_CPP
+
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <glm/glm.hpp>
+
+#include "aabb.cpp"
+
+// Nó binário de 32 bytes: as caixas dos dois filhos em 16 bits por
+// coordenada, na grade de 65535 passos da caixa do pai (já decodificada), e a
+// referência de cada filho: índice de nó ou, com leaf_bit, índice de folha.
+struct QuantizedNode {
+    static constexpr uint32_t leaf_bit = 1u << 31;
+
+    uint16_t bounds[2][6];   // min xyz, max xyz
+    uint32_t child[2];
+};
+
+static_assert(sizeof(QuantizedNode) == 32);
+
+// BVH compacto para manter muitas árvores residentes: só os nós quantizados,
+// o início de cada folha e a permutação dos triângulos (a árvore binária usada
+// na construção é descartada). As consultas decodificam as caixas filho a
+// filho a partir da raiz, sempre arredondadas para fora.
+class QuantizedBVH {
+    Mesh mesh;
+    SplitStrategy strategy;
+    AABB root_box;
+    uint32_t root_ref{0};
+    std::vector<QuantizedNode> nodes;
+    // Folha i cobre triangle_indices[leaf_offsets[i], leaf_offsets[i + 1])
+    std::vector<unsigned> leaf_offsets;
+    std::vector<unsigned> triangle_indices;
+
+    static constexpr float grid = 65535.0f;
+
+public:
+    QuantizedBVH(Mesh m, SplitStrategy split = SplitStrategy::Median) : mesh(std::move(m)), strategy(split) {}
+
+    void build(objloader::ThreadPool* pool = &objloader::ThreadPool::shared()) {
+        nodes.clear();
+        leaf_offsets.clear();
+        triangle_indices.clear();
+
+        AABBTree tree(mesh, strategy);
+        tree.build(pool);
+        if (tree.empty()) return;
+
+        auto order = tree.triangles(tree.node(AABBTree::root));
+        triangle_indices.assign(order.begin(), order.end());
+
+        nodes.reserve(tree.nodeCount() / 2);
+        root_box = tree.volume(AABBTree::root);
+        root_ref = encode(tree, AABBTree::root, root_box);
+        leaf_offsets.push_back((unsigned)triangle_indices.size());
+
+        nodes.shrink_to_fit();
+        leaf_offsets.shrink_to_fit();
+    }
+
+    bool empty() const { return leaf_offsets.empty(); }
+    size_t nodeCount() const { return nodes.size(); }
+
+    size_t memoryBytes() const {
+        return nodes.capacity() * sizeof(QuantizedNode) +
+               (leaf_offsets.capacity() + triangle_indices.capacity()) * sizeof(unsigned);
+    }
+
+    static bool isLeaf(uint32_t ref) { return ref & QuantizedNode::leaf_bit; }
+
+    uint32_t rootRef() const { return root_ref; }
+    const AABB& rootBox() const { return root_box; }
+    const QuantizedNode& node(uint32_t ref) const { return nodes[ref]; }
+
+    // Caixa do filho side de node, sendo parent a caixa (decodificada) do nó
+    static AABB childBox(const QuantizedNode& node, unsigned side, const AABB& parent) {
+        const glm::vec3 step = gridStep(parent);
+        const uint16_t* q = node.bounds[side];
+        return AABB(parent.min_corner + glm::vec3(q[0], q[1], q[2]) * step,
+                    parent.min_corner + glm::vec3(q[3], q[4], q[5]) * step);
+    }
+
+    // Índices em getMesh().triangles da folha ref
+    std::span<const unsigned> triangles(uint32_t ref) const {
+        const uint32_t leaf = ref & ~QuantizedNode::leaf_bit;
+        return {triangle_indices.data() + leaf_offsets[leaf], leaf_offsets[leaf + 1] - leaf_offsets[leaf]};
+    }
+
+    const Mesh& getMesh() const { return mesh; }
+    const Mesh::coordinate_t& coordinates() const { return *mesh.coordinates; }
+    const std::array<unsigned, 3>& triangle(unsigned index) const { return mesh.triangles[index]; }
+
+    // Mesmo contrato de AABBTree::raycast
+    bool raycast(const Ray& ray, RayHit& hit) const {
+        if (empty()) return false;
+
+        struct Entry {
+            uint32_t ref;
+            AABB box;
+        };
+
+        const glm::vec3 inv_direction = 1.0f / ray.direction;
+        const auto& coords = coordinates();
+        bool found = false;
+
+        float t_near;
+        if (!root_box.intersects(ray, inv_direction, hit.t, t_near)) return false;
+
+        Entry stack[64];
+        unsigned size = 0;
+        stack[size++] = {root_ref, root_box};
+
+        while (size > 0) {
+            const Entry entry = stack[--size];
+
+            if (isLeaf(entry.ref)) {
+                for (unsigned t : triangles(entry.ref)) {
+                    const auto& tri = mesh.triangles[t];
+                    float distance;
+                    if (intersectTriangle(ray, coords[tri[0]], coords[tri[1]], coords[tri[2]], hit.t, distance)) {
+                        hit = {distance, t};
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            const QuantizedNode& node = nodes[entry.ref];
+            AABB left = childBox(node, 0, entry.box);
+            AABB right = childBox(node, 1, entry.box);
+            float t_left, t_right;
+            bool hit_left = left.intersects(ray, inv_direction, hit.t, t_left);
+            bool hit_right = right.intersects(ray, inv_direction, hit.t, t_right);
+
+            // O mais próximo por último, para sair primeiro da pilha
+            if (hit_left && hit_right && t_left < t_right) {
+                stack[size++] = {node.child[1], right};
+                stack[size++] = {node.child[0], left};
+            }
+            else {
+                if (hit_left) stack[size++] = {node.child[0], left};
+                if (hit_right) stack[size++] = {node.child[1], right};
+            }
+        }
+
+        return found;
+    }
+
+private:
+    // Passo da grade: um pouco maior que extensão / 65535 para que o último
+    // passo alcance o máximo do pai mesmo com o arredondamento da soma.
+    static glm::vec3 gridStep(const AABB& parent) {
+        glm::vec3 slack = (glm::abs(parent.min_corner) + glm::abs(parent.max_corner)) * 0x1p-20f;
+        return (parent.max_corner - parent.min_corner + slack) / grid;
+    }
+
+    // Menor/maior passo cuja coordenada decodificada ainda fica do lado de fora
+    // de value, com um passo de folga para diferenças de arredondamento.
+    static uint16_t quantizeDown(float value, float origin, float step) {
+        if (step <= 0.0f) return 0;
+        float q = std::clamp(std::floor((value - origin) / step) - 1.0f, 0.0f, grid);
+        while (q > 0.0f && origin + q * step > value) q -= 1.0f;
+        return (uint16_t)q;
+    }
+
+    static uint16_t quantizeUp(float value, float origin, float step) {
+        if (step <= 0.0f) return 0;
+        float q = std::clamp(std::ceil((value - origin) / step) + 1.0f, 0.0f, grid);
+        while (q < grid && origin + q * step < value) q += 1.0f;
+        return (uint16_t)q;
+    }
+
+    // Referência do nó binary, cuja caixa decodificada é box; emite em
+    // profundidade e numera as folhas na ordem dos triângulos.
+    uint32_t encode(const AABBTree& tree, unsigned binary, const AABB& box) {
+        const AABBNode& source = tree.node(binary);
+        if (source.isLeaf()) {
+            leaf_offsets.push_back(source.offset);
+            return uint32_t(leaf_offsets.size() - 1) | QuantizedNode::leaf_bit;
+        }
+
+        const uint32_t index = (uint32_t)nodes.size();
+        nodes.emplace_back();
+
+        const glm::vec3 step = gridStep(box);
+        const unsigned children[2] = {tree.leftChild(binary), tree.rightChild(binary)};
+        QuantizedNode node;
+
+        for (unsigned side = 0; side < 2; ++side) {
+            const AABB& child = tree.volume(children[side]);
+            for (int axis = 0; axis < 3; ++axis) {
+                node.bounds[side][axis] = quantizeDown(child.min_corner[axis], box.min_corner[axis], step[axis]);
+                node.bounds[side][axis + 3] = quantizeUp(child.max_corner[axis], box.min_corner[axis], step[axis]);
+            }
+        }
+
+        for (unsigned side = 0; side < 2; ++side) {
+            node.child[side] = encode(tree, children[side], childBox(node, side, box));
+        }
+
+        nodes[index] = node;
+        return index;
+    }
+};
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef PROVA03_TREE_CACHE_CPP
+#define PROVA03_TREE_CACHE_CPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "aabb.cpp"
+#include "mapped_file.hpp"
+#include "profile.hpp"
+
+// AABBTree construída gravada em disco ("<arquivo>.bvh") e mapeada de volta:
+// nós em profundidade e permutação dos triângulos exatamente como ficam na
+// memória, então a leitura não corrige nada. A entrada vale para a malha cujo
+// hash está no cabeçalho, construída com a mesma estratégia.
+namespace tree_cache {
+
+constexpr char magic[8] = {'M', 'C', '9', '3', '7', 'B', 'V', 'H'};
+constexpr uint32_t version = 1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t meshHash;
+    uint64_t nodeCount;
+    uint64_t triangleCount;
+    uint32_t nodeSize;
+    uint32_t strategy;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(Header) == 56);
+
+constexpr size_t align16(size_t n) {
+    return (n + 15) & ~size_t(15);
+}
+
+// Deslocamentos dos arrays no arquivo, alinhados a 16 bytes
+struct Layout {
+    size_t nodes, indices, total;
+
+    Layout(uint64_t nodeCount, uint64_t triangleCount) {
+        nodes = align16(sizeof(Header));
+        indices = align16(nodes + nodeCount * sizeof(AABBNode));
+        total = indices + triangleCount * sizeof(unsigned);
+    }
+};
+
+// FNV-1a de 64 bits de 8 em 8 bytes
+inline uint64_t hashBytes(const void* data, size_t bytes, uint64_t h) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (; bytes >= 8; bytes -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        h = (h ^ word) * 0x100000001b3ull;
+    }
+    for (; bytes > 0; --bytes, ++p) {
+        h = (h ^ *p) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+// Coordenadas e triângulos, na ordem: a permutação depende dos dois
+inline uint64_t hashMesh(const Mesh& mesh) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    h = hashBytes(mesh.coordinates->data(), mesh.coordinates->size() * sizeof(glm::vec3), h);
+    return hashBytes(mesh.triangles.data(), mesh.triangles.size() * sizeof(mesh.triangles[0]), h);
+}
+
+}
+
+inline std::string treeCachePath(const std::string& objPath) {
+    return objPath + ".bvh";
+}
+
+// Mapeia a árvore gravada em path para tree, que já tem a malha e a
+// estratégia. Falso se o arquivo não existe, é de outra malha/estratégia ou
+// traz nós que não formam uma árvore válida (AABBTree::attach confere).
+inline bool readTreeCache(const std::string& path, AABBTree& tree) {
+    using namespace tree_cache;
+
+    auto file = std::make_shared<objloader::MappedFile>();
+    if (!file->open(path) || file->size() < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+        header.version != version ||
+        header.headerSize != sizeof(Header) ||
+        header.nodeSize != sizeof(AABBNode) ||
+        header.strategy != (uint32_t)tree.splitStrategy() ||
+        header.triangleCount != tree.getMesh().triangles.size() ||
+        header.meshHash != hashMesh(tree.getMesh())) {
+        return false;
+    }
+
+    // Contagens absurdas estourariam as multiplicações do Layout
+    if (header.nodeCount > file->size() / sizeof(AABBNode) ||
+        header.triangleCount > file->size() / sizeof(unsigned)) {
+        return false;
+    }
+
+    Layout layout(header.nodeCount, header.triangleCount);
+    if (layout.total != file->size()) return false;
+
+    const char* base = file->data();
+    std::span<const AABBNode> nodes(reinterpret_cast<const AABBNode*>(base + layout.nodes), header.nodeCount);
+    std::span<const unsigned> indices(reinterpret_cast<const unsigned*>(base + layout.indices), header.triangleCount);
+    return tree.attach(nodes, indices, std::move(file));
+}
+
+inline bool writeTreeCache(const std::string& path, const AABBTree& tree) {
+    using namespace tree_cache;
+
+    auto nodes = tree.allNodes();
+    auto indices = tree.allTriangles();
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.headerSize = sizeof(Header);
+    header.meshHash = hashMesh(tree.getMesh());
+    header.nodeCount = nodes.size();
+    header.triangleCount = indices.size();
+    header.nodeSize = sizeof(AABBNode);
+    header.strategy = (uint32_t)tree.splitStrategy();
+
+    Layout layout(header.nodeCount, header.triangleCount);
+
+    // Grava num temporário e renomeia para nunca expor uma árvore incompleta
+    const std::string tmpPath = path + ".tmp";
+
+    FILE* out = std::fopen(tmpPath.c_str(), "wb");
+    if (!out) return false;
+
+    static const char padding[16] = {};
+    auto writeAt = [&](size_t offset, const void* data, size_t bytes) {
+        long pos = std::ftell(out);
+        if (pos < 0 || (size_t)pos > offset) return false;
+        if (std::fwrite(padding, 1, offset - pos, out) != offset - (size_t)pos) return false;
+        return bytes == 0 || std::fwrite(data, 1, bytes, out) == bytes;
+    };
+
+    bool ok = writeAt(0, &header, sizeof(header)) &&
+              writeAt(layout.nodes, nodes.data(), nodes.size_bytes()) &&
+              writeAt(layout.indices, indices.data(), indices.size_bytes());
+
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+// Usa a árvore gravada ao lado do OBJ se servir; senão constrói e grava.
+// Retorna se a árvore veio do arquivo.
+inline bool loadTreeCached(const std::string& objPath, AABBTree& tree) {
+    const std::string path = treeCachePath(objPath);
+    {
+        objloader::profile::ScopedTimer timer(objloader::profile::Phase::TreeRead);
+        if (readTreeCache(path, tree)) return true;
+    }
+
+    {
+        objloader::profile::ScopedTimer timer(objloader::profile::Phase::TreeBuild);
+        tree.build();
+    }
+
+    objloader::profile::ScopedTimer timer(objloader::profile::Phase::TreeWrite);
+    if (!writeTreeCache(path, tree)) {
+        std::cerr << "Aviso: não foi possível gravar a árvore " << path << std::endl;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,285 @@
+#ifndef PROVA03_WIDE_BVH_CPP
+#define PROVA03_WIDE_BVH_CPP
+
+#include <bit>
+#include <span>
+#include <glm/glm.hpp>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "aabb.cpp"
+
+// Nó de um BVH com até Width filhos. As caixas ficam em SoA para testar todos
+// os filhos com uma sequência de instruções: 4 pistas por vez com SSE, 8 com
+// AVX. Os filhos usados são sempre os primeiros; as demais pistas têm caixa
+// vazia e são descartadas pela máscara.
+template <unsigned Width>
+struct alignas(Width * sizeof(float)) WideNode {
+    static_assert(Width % 4 == 0 && Width <= 16, "largura em múltiplos de 4 pistas, até 16");
+
+    float min_x[Width], min_y[Width], min_z[Width];
+    float max_x[Width], max_y[Width], max_z[Width];
+    unsigned child[Width];   // interno: índice em WideBVH::nodes; folha: nó do AABBTree
+    unsigned leaves{0};      // bit k: o filho k é folha
+    unsigned children{0};
+
+    bool isLeaf(unsigned k) const { return leaves >> k & 1; }
+    unsigned lanes() const { return (1u << children) - 1; }
+
+    AABB box(unsigned k) const {
+        return AABB(glm::vec3(min_x[k], min_y[k], min_z[k]), glm::vec3(max_x[k], max_y[k], max_z[k]));
+    }
+
+    // Bit k: a caixa do filho k toca box
+    unsigned overlap(const AABB& box) const {
+        unsigned mask = 0;
+#if defined(__AVX__)
+        if constexpr (Width % 8 == 0) {
+            for (unsigned b = 0; b < Width; b += 8) {
+                __m256 x = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(min_x + b), _mm256_set1_ps(box.max_corner.x), _CMP_LE_OQ),
+                                         _mm256_cmp_ps(_mm256_load_ps(max_x + b), _mm256_set1_ps(box.min_corner.x), _CMP_GE_OQ));
+                __m256 y = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(min_y + b), _mm256_set1_ps(box.max_corner.y), _CMP_LE_OQ),
+                                         _mm256_cmp_ps(_mm256_load_ps(max_y + b), _mm256_set1_ps(box.min_corner.y), _CMP_GE_OQ));
+                __m256 z = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(min_z + b), _mm256_set1_ps(box.max_corner.z), _CMP_LE_OQ),
+                                         _mm256_cmp_ps(_mm256_load_ps(max_z + b), _mm256_set1_ps(box.min_corner.z), _CMP_GE_OQ));
+                mask |= unsigned(_mm256_movemask_ps(_mm256_and_ps(x, _mm256_and_ps(y, z)))) << b;
+            }
+            return mask & lanes();
+        }
+#endif
+#if defined(__SSE2__)
+        for (unsigned b = 0; b < Width; b += 4) {
+            __m128 x = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(min_x + b), _mm_set1_ps(box.max_corner.x)),
+                                  _mm_cmpge_ps(_mm_load_ps(max_x + b), _mm_set1_ps(box.min_corner.x)));
+            __m128 y = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(min_y + b), _mm_set1_ps(box.max_corner.y)),
+                                  _mm_cmpge_ps(_mm_load_ps(max_y + b), _mm_set1_ps(box.min_corner.y)));
+            __m128 z = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(min_z + b), _mm_set1_ps(box.max_corner.z)),
+                                  _mm_cmpge_ps(_mm_load_ps(max_z + b), _mm_set1_ps(box.min_corner.z)));
+            mask |= unsigned(_mm_movemask_ps(_mm_and_ps(x, _mm_and_ps(y, z)))) << b;
+        }
+#else
+        for (unsigned k = 0; k < Width; ++k) {
+            mask |= unsigned(box.intersects(this->box(k))) << k;
+        }
+#endif
+        return mask & lanes();
+    }
+
+    // Bit k: o raio entra no filho k antes de t_max; t_near[k] recebe a entrada
+    unsigned intersect(const Ray& ray, const glm::vec3& inv_direction, float t_max, float* t_near) const {
+        unsigned mask = 0;
+#if defined(__AVX__)
+        if constexpr (Width % 8 == 0) {
+            const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+            const __m256 ix = _mm256_set1_ps(inv_direction.x), iy = _mm256_set1_ps(inv_direction.y), iz = _mm256_set1_ps(inv_direction.z);
+            for (unsigned b = 0; b < Width; b += 8) {
+                __m256 x0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(min_x + b), ox), ix);
+                __m256 x1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(max_x + b), ox), ix);
+                __m256 y0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(min_y + b), oy), iy);
+                __m256 y1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(max_y + b), oy), iy);
+                __m256 z0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(min_z + b), oz), iz);
+                __m256 z1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(max_z + b), oz), iz);
+
+                __m256 enter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(x0, x1), _mm256_min_ps(y0, y1)), _mm256_min_ps(z0, z1));
+                __m256 leave = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(x0, x1), _mm256_max_ps(y0, y1)), _mm256_max_ps(z0, z1));
+                __m256 hit = _mm256_and_ps(_mm256_cmp_ps(enter, leave, _CMP_LE_OQ),
+                                           _mm256_and_ps(_mm256_cmp_ps(leave, _mm256_setzero_ps(), _CMP_GE_OQ),
+                                                         _mm256_cmp_ps(enter, _mm256_set1_ps(t_max), _CMP_LE_OQ)));
+                _mm256_storeu_ps(t_near + b, enter);
+                mask |= unsigned(_mm256_movemask_ps(hit)) << b;
+            }
+            return mask & lanes();
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+        const __m128 ix = _mm_set1_ps(inv_direction.x), iy = _mm_set1_ps(inv_direction.y), iz = _mm_set1_ps(inv_direction.z);
+        for (unsigned b = 0; b < Width; b += 4) {
+            __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(min_x + b), ox), ix);
+            __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(max_x + b), ox), ix);
+            __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(min_y + b), oy), iy);
+            __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(max_y + b), oy), iy);
+            __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(min_z + b), oz), iz);
+            __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(max_z + b), oz), iz);
+
+            __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)), _mm_min_ps(z0, z1));
+            __m128 leave = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)), _mm_max_ps(z0, z1));
+            __m128 hit = _mm_and_ps(_mm_cmple_ps(enter, leave),
+                                    _mm_and_ps(_mm_cmpge_ps(leave, _mm_setzero_ps()), _mm_cmple_ps(enter, _mm_set1_ps(t_max))));
+            _mm_storeu_ps(t_near + b, enter);
+            mask |= unsigned(_mm_movemask_ps(hit)) << b;
+        }
+#else
+        for (unsigned k = 0; k < Width; ++k) {
+            mask |= unsigned(box(k).intersects(ray, inv_direction, t_max, t_near[k])) << k;
+        }
+#endif
+        return mask & lanes();
+    }
+};
+
+// BVH de Width filhos por nó, obtido achatando o AABBTree (mesma construção e
+// mesmas folhas): cada nó largo absorve os descendentes binários de maior
+// área até ter Width filhos, o que divide a profundidade por ~log2(Width).
+template <unsigned Width>
+class WideBVH {
+    AABBTree tree;
+    std::vector<WideNode<Width>> nodes;
+
+public:
+    static constexpr unsigned width = Width;
+    static constexpr unsigned root = 0;
+
+    WideBVH(Mesh m, SplitStrategy split = SplitStrategy::Median) : tree(std::move(m), split) {}
+
+    void build(objloader::ThreadPool* pool = &objloader::ThreadPool::shared()) {
+        tree.build(pool);
+        nodes.clear();
+        if (tree.empty()) return;
+
+        nodes.reserve(tree.nodeCount() / (Width - 1) + 1);
+        collapse(AABBTree::root);
+        nodes.shrink_to_fit();
+    }
+
+    bool empty() const { return nodes.empty(); }
+    size_t nodeCount() const { return nodes.size(); }
+    size_t memoryBytes() const { return tree.memoryBytes() + nodes.capacity() * sizeof(WideNode<Width>); }
+    const WideNode<Width>& node(unsigned index) const { return nodes[index]; }
+
+    const Mesh& getMesh() const { return tree.getMesh(); }
+    const Mesh::coordinate_t& coordinates() const { return tree.coordinates(); }
+
+    // Triângulos do filho k, que precisa ser folha
+    std::span<const unsigned> triangles(const WideNode<Width>& node, unsigned k) const {
+        return tree.triangles(tree.node(node.child[k]));
+    }
+
+    const std::array<unsigned, 3>& triangle(unsigned index) const { return tree.triangle(index); }
+
+    // Mesmo contrato de AABBTree::raycast
+    bool raycast(const Ray& ray, RayHit& hit) const {
+        if (nodes.empty()) return false;
+
+        struct Entry {
+            unsigned node;
+            float t_near;
+        };
+
+        const glm::vec3 inv_direction = 1.0f / ray.direction;
+        const auto& coords = coordinates();
+        bool found = false;
+
+        Entry stack[32 * Width];
+        unsigned size = 0;
+        stack[size++] = {root, std::numeric_limits<float>::lowest()};
+
+        while (size > 0) {
+            const Entry entry = stack[--size];
+            // Entrou depois do acerto que já temos
+            if (entry.t_near > hit.t) continue;
+
+            const WideNode<Width>& node = nodes[entry.node];
+            float t_near[Width];
+            unsigned mask = node.intersect(ray, inv_direction, hit.t, t_near);
+
+            // Internos em ordem decrescente de entrada: o mais próximo sai primeiro
+            Entry inner[Width];
+            unsigned count = 0;
+            for (; mask; mask &= mask - 1) {
+                const unsigned k = std::countr_zero(mask);
+
+                if (node.isLeaf(k)) {
+                    for (unsigned t : triangles(node, k)) {
+                        const auto& tri = triangle(t);
+                        float distance;
+                        if (intersectTriangle(ray, coords[tri[0]], coords[tri[1]], coords[tri[2]], hit.t, distance)) {
+                            hit = {distance, t};
+                            found = true;
+                        }
+                    }
+                    continue;
+                }
+
+                unsigned i = count++;
+                while (i > 0 && inner[i - 1].t_near < t_near[k]) {
+                    inner[i] = inner[i - 1];
+                    --i;
+                }
+                inner[i] = {node.child[k], t_near[k]};
+            }
+
+            for (unsigned i = 0; i < count; ++i) stack[size++] = inner[i];
+        }
+
+        return found;
+    }
+
+private:
+    // Nó largo com os descendentes de binary: abre sempre o filho interno de
+    // maior área até ter Width filhos ou só restarem folhas. Emite em
+    // profundidade, como o AABBTree.
+    unsigned collapse(unsigned binary) {
+        unsigned candidates[Width];
+        unsigned count = 0;
+
+        if (tree.node(binary).isLeaf()) {
+            candidates[count++] = binary;
+        }
+        else {
+            candidates[count++] = tree.leftChild(binary);
+            candidates[count++] = tree.rightChild(binary);
+        }
+
+        while (count < Width) {
+            unsigned best = count;
+            float best_area = -1.0f;
+            for (unsigned k = 0; k < count; ++k) {
+                if (tree.node(candidates[k]).isLeaf()) continue;
+                float area = tree.volume(candidates[k]).surfaceArea();
+                if (area > best_area) {
+                    best_area = area;
+                    best = k;
+                }
+            }
+            if (best == count) break;
+
+            const unsigned open = candidates[best];
+            candidates[best] = tree.leftChild(open);
+            candidates[count++] = tree.rightChild(open);
+        }
+
+        const unsigned index = (unsigned)nodes.size();
+        nodes.emplace_back();
+
+        WideNode<Width> node;
+        node.children = count;
+        for (unsigned k = 0; k < Width; ++k) {
+            AABB box = k < count ? tree.volume(candidates[k]) : AABB();
+            node.min_x[k] = box.min_corner.x;
+            node.min_y[k] = box.min_corner.y;
+            node.min_z[k] = box.min_corner.z;
+            node.max_x[k] = box.max_corner.x;
+            node.max_y[k] = box.max_corner.y;
+            node.max_z[k] = box.max_corner.z;
+            node.child[k] = 0;
+
+            if (k >= count) continue;
+
+            if (tree.node(candidates[k]).isLeaf()) {
+                node.child[k] = candidates[k];
+                node.leaves |= 1u << k;
+            }
+            else {
+                node.child[k] = collapse(candidates[k]);
+            }
+        }
+
+        nodes[index] = node;
+        return index;
+    }
+};
+
+#endif